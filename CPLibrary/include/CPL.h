@@ -18,6 +18,7 @@
 namespace CPL {
 enum class DrawModes : uint8_t;
 enum class TextureFiltering : uint8_t;
+enum class FontRendering : uint8_t;
 enum class PostProcessingModes : uint8_t;
 
 struct Color;
@@ -32,6 +33,8 @@ class Triangle;
 class Rectangle;
 class Circle;
 class Line;
+class ShapeBatch;
+class SpriteBatch;
 class Texture2D;
 class ParticleSystem;
 
@@ -83,6 +86,8 @@ void SetShininess3D(float shininess);
 void AddPointLights3D(const std::vector<PointLight3D> &lights);
 void SetDirLight3D(const DirectionalLight &light);
 void EnableFog(bool enabled);
+void EnableShadows(bool enabled);
+void SetShadowFilter(int radius);
 void SetFog(float fogStart, float fogEnd, const Color &color);
 void EnableTransparency();
 void EnableDepth(bool enabled);
@@ -109,14 +114,23 @@ void DrawCircle(const glm::vec2 &pos, float radius, const Color &color);
 void DrawCircleOut(const glm::vec2 &pos, float radius, const Color &color);
 void DrawLine(const glm::vec2 &startPos, const glm::vec2 &endPos,
               const Color &color);
-void DrawTex2D(Texture2D *tex, const glm::vec2 &pos, const Color &color);
+void EnableShapeBatching(bool enabled);
+void EnableSpriteBatching(bool enabled);
+void EnableSpriteSorting(bool enabled);
+void EnableInstancing(bool enabled);
+void EnableDrawQueue(bool enabled);
+void DrawTex2D(Texture2D *tex, const glm::vec2 &pos, const Color &color,
+               int layer = 0);
 void DrawTex2DRot(Texture2D *tex, const glm::vec2 &pos, float angle,
-                  const Color &color);
+                  const Color &color, int layer = 0);
 void DrawText(const glm::vec2 &pos, float scale, const std::string &text,
               const Color &color);
 void DrawTextShadow(const glm::vec2 &pos, const glm::vec2 &shadowOff,
                     float scale, const std::string &text, const Color &color,
                     const Color &shadowColor);
+void DrawTextOutline(const glm::vec2 &pos, float scale, const std::string &text,
+                     const Color &color, const Color &outlineColor,
+                     float outlineWidth);
 std::string GetDefaultFont();
 void DrawCube(const glm::vec3 &pos, const glm::vec3 &size, const Color &color);
 void DrawSphere(const glm::vec3 &pos, float radius, const Color &color);
@@ -175,5 +189,6 @@ Camera3D &GetCam3D();
 GLFWwindow *GetWindow();
 
 Shader &GetShader(const DrawModes &mode);
+Shader &GetTextSDFShader();
 DrawModes &GetCurMode();
 } // namespace CPL
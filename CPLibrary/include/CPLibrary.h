@@ -6,10 +6,15 @@
 
 #include "Audio.h"
 #include "CPL.h"
+#include "DrawQueue.h"
 #include "Engine.h"
 #include "Screenshot.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "ShaderVariants.h"
 #include "Text.h"
+#include "TextMesh.h"
+#include "UniformBlocks.h"
 #include "shape2D/Circle.h"
 #include "shape2D/GlobalLight.h"
 #include "shape2D/Line.h"
@@ -18,6 +23,7 @@
 #include "shape2D/Rectangle.h"
 #include "shape2D/ScreenQuad.h"
 #include "shape2D/Texture2D.h"
+#include "shape2D/TextureAtlas.h"
 #include "shape2D/Tilemap.h"
 #include "shape2D/Triangle.h"
 #include "shape3D/Cube.h"
@@ -25,12 +31,18 @@
 #include "shape3D/CubeTex.h"
 #include "shape3D/DirectionalLight.h"
 #include "shape3D/Frustum.h"
+#include "shape3D/InstanceBatch.h"
 #include "shape3D/PlaneTex.h"
 #include "shape3D/PointLight3D.h"
 #include "shape3D/ShadowMap.h"
 #include "shape3D/Sphere.h"
+#include "shape3D/SphereGeometry.h"
 #include "timer/TimerManager.h"
+#include "util/GLState.h"
 #include "util/Logging.h"
+#include "util/MappedFile.h"
 #include "util/OpenGLDebug.h"
 #include "util/ScopedTimer.h"
+#include "util/Simd.h"
+#include "util/ThreadPool.h"
 #include <GLFW/glfw3.h>
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CPL.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace CPL {
+class Shader;
+
+// One draw of a batched primitive, replayed into the batches later.
+// Lines keep startPos in pos & endPos in size, circles the radius in size.x
+struct DrawCommand {
+    enum class Type : uint8_t {
+        RECT,
+        TRIANGLE,
+        CIRCLE,
+        LINE,
+        SPRITE,
+        INSTANCE,
+    };
+
+    Type type = Type::RECT;
+    // Filled shape or atlas cube
+    bool flag = false;
+    // Index of the camera it was recorded with, set by DrawQueue
+    uint8_t view = 0;
+    int layer = 0;
+    const Shader *shader = nullptr;
+    uint32_t texture = 0;
+    uint32_t mesh = 0;
+    glm::vec3 pos{0.0f};
+    glm::vec3 size{0.0f};
+    float angle = 0;
+    glm::vec4 uvRect{0.0f};
+    Color color;
+
+    static DrawCommand Shape(Type type, const Shader &shader,
+                             const glm::vec2 &pos, const glm::vec2 &size,
+                             float angle, const Color &color, bool filled);
+    static DrawCommand Sprite(const Shader &shader, uint32_t texture,
+                              int layer, const glm::vec2 &pos,
+                              const glm::vec2 &size, float angle,
+                              const glm::vec4 &uvRect, const Color &color);
+    static DrawCommand Instance(const Shader &shader, uint32_t mesh,
+                                uint32_t texture, const glm::vec3 &pos,
+                                const glm::vec3 &size, const Color &color,
+                                bool atlas);
+};
+
+// Records draw commands with a 64 bit sort key & radix sorts them on Sort.
+// Key from high to low bits:
+//   view (4) | layer (8) | 1 (1) | sequence (51)           2D & alpha < 255
+//   view (4) | layer (8) | 0 (1) | shader (6) | texture (16) | mesh (5) |
+//   depth (24)
+// Every BeginDraw that records something gets its own view, numbered in
+// call order, so 2D & 3D passes stay in order & layers only sort inside a
+// pass. Translucent draws keep the order they were recorded in (painter's
+// order), opaque 3D draws come first & are grouped by shader & texture/mesh,
+// front to back inside a group, so the depth test rejects hidden fragments
+// early
+class DrawQueue {
+  public:
+    struct Entry {
+        uint64_t key;
+        uint32_t index;
+    };
+    // Camera & depth state of a BeginDraw
+    struct View {
+        glm::mat4 projection{1.0f};
+        glm::vec3 viewPos{0.0f};
+        bool depthTest = false;
+    };
+
+    static constexpr size_t maxViews = 16;
+
+    // Used for the commands recorded after it, only stored once the first
+    // command uses it
+    void SetView(const View &view);
+    [[nodiscard]] const View &GetCurrentView() const { return m_Current; }
+
+    // False if the view table is full, submit the queue & record again
+    bool Record(const DrawCommand &command);
+
+    // Sorted entries, valid until the next Record or Clear
+    const std::vector<Entry> &Sort();
+    [[nodiscard]] const DrawCommand &GetCommand(const uint32_t index) const {
+        return m_Commands[index];
+    }
+    [[nodiscard]] const View &GetView(const uint8_t index) const {
+        return m_Views[index];
+    }
+
+    void Clear();
+    [[nodiscard]] bool IsEmpty() const { return m_Commands.empty(); }
+    [[nodiscard]] size_t GetSize() const { return m_Commands.size(); }
+
+  private:
+    std::vector<DrawCommand> m_Commands;
+    std::vector<Entry> m_Entries;
+    // Scratch buffer of the radix sort
+    std::vector<Entry> m_Sorted;
+    std::vector<View> m_Views;
+    std::vector<const Shader *> m_Shaders;
+    View m_Current;
+    bool m_CurrentStored = false;
+    uint64_t m_Sequence = 0;
+
+    uint64_t m_MakeKey(const DrawCommand &command);
+    uint64_t m_ShaderID(const Shader *shader);
+};
+} // namespace CPL
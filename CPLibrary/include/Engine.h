@@ -3,6 +3,8 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <queue>
 #include <random>
@@ -28,6 +30,10 @@ enum class TextureFiltering : uint8_t {
     NEAREST,
     LINEAR,
 };
+enum class FontRendering : uint8_t {
+    BITMAP,
+    SDF,
+};
 enum class PostProcessingModes : uint8_t {
     DEFAULT,
     INVERSE,
@@ -43,18 +49,33 @@ struct Color {
         : r(r), g(g), b(b), a(a) {}
     Color(const float val) : r(val), g(val), b(val), a(val) {}
     float r, g, b, a;
+
+    // RGBA8 (r in the lowest byte) for vertex colors
+    [[nodiscard]] uint32_t Pack() const {
+        const auto channel = [](const float v) {
+            return static_cast<uint32_t>(std::clamp(v, 0.0f, 255.0f) + 0.5f);
+        };
+        return channel(r) | (channel(g) << 8) | (channel(b) << 16) |
+               (channel(a) << 24);
+    }
 };
 
 struct Timer;
 class TimerManager;
 
 class Shader;
+class ShaderVariants;
 class GlobalLight;
 class PointLight;
 class Triangle;
 class Rectangle;
 class Circle;
 class Line;
+class ShapeBatch;
+class SpriteBatch;
+class InstanceBatch;
+struct DrawCommand;
+class DrawQueue;
 class Texture2D;
 class ParticleSystem;
 
@@ -125,6 +146,7 @@ struct Camera3D {
 class ScreenQuad;
 
 struct Character;
+struct TextStyle;
 class Text;
 
 struct Audio;
@@ -151,6 +173,8 @@ class Engine {
     static void InitShaders();
     static CPL::DrawModes &GetCurMode();
     static CPL::Shader &GetShader(const CPL::DrawModes &mode);
+    // Shader for TextMesh::Draw with SDF fonts
+    static CPL::Shader &GetTextSDFShader();
 
     static void DrawTriangle(const glm::vec2 &pos, const glm::vec2 &size,
                              const CPL::Color &color);
@@ -174,10 +198,21 @@ class Engine {
                               const CPL::Color &color);
     static void DrawLine(const glm::vec2 &startPos, const glm::vec2 &endPos,
                          const CPL::Color &color);
+    static void EnableShapeBatching(bool enabled);
+    static void EnableSpriteBatching(bool enabled);
+    // Group batched sprites of a layer by texture instead of call order
+    static void EnableSpriteSorting(bool enabled);
+    // Instanced drawing of DrawCube, DrawCubeTex(Atlas) & DrawSphere
+    static void EnableInstancing(bool enabled);
+    // Record batched draws & sort them at EndDraw (or any other flush)
+    static void EnableDrawQueue(bool enabled);
+    // Draws the collected shapes, sprites & 3D instances now, every draw
+    // that is not batched calls it first to keep the order
+    static void FlushBatches();
     static void DrawTex2D(CPL::Texture2D *tex, const glm::vec2 &pos,
-                          const CPL::Color &color);
+                          const CPL::Color &color, int layer);
     static void DrawTex2DRot(CPL::Texture2D *tex, const glm::vec2 &pos,
-                             float angle, const CPL::Color &color);
+                             float angle, const CPL::Color &color, int layer);
 
     static void DrawText(const glm::vec2 &pos, float scale,
                          const std::string &text, const CPL::Color &color);
@@ -185,6 +220,11 @@ class Engine {
                                float scale, const std::string &text,
                                const CPL::Color &color,
                                const CPL::Color &shadowColor);
+    static void DrawTextOutline(const glm::vec2 &pos, float scale,
+                                const std::string &text,
+                                const CPL::Color &color,
+                                const CPL::Color &outlineColor,
+                                float outlineWidth);
 
     static void DrawCube(const glm::vec3 &pos, const glm::vec3 &size,
                          const CPL::Color &color);
@@ -204,6 +244,10 @@ class Engine {
                         const CPL::Color &color);
     static void DrawCubeMap(const CPL::CubeMap *map);
     static void DrawCubeMapRot(CPL::CubeMap *map, const glm::vec3 &rot);
+    // Called by ShadowMap, cubes & spheres drawn in between are rendered
+    // into the shadow map with the depth shader
+    static void BeginDepthPass(const glm::mat4 &lightSpaceMatrix);
+    static void EndDepthPass();
 
     static void ResetShader();
 
@@ -217,6 +261,13 @@ class Engine {
     static void AddPointLights3D(const std::vector<CPL::PointLight3D> &lights);
     static void SetDirLight3D(const CPL::DirectionalLight &light);
     static void EnableFog(bool enabled);
+    // Called by ShadowMap::BindForReading, switches to the shadow variant
+    static void SetShadowMap(uint32_t textureUnit,
+                             const glm::mat4 &lightSpaceMatrix);
+    static void EnableShadows(bool enabled);
+    // PCF radius of the shadow lookup in texels, 0 = hard, 1 = 3x3 (default)
+    // Recompiles the shadow variants, so don't call it every frame
+    static void SetShadowFilter(int radius);
     static void SetFog(float fogStart, float fogEnd, const CPL::Color &color);
     static void BeginPostProcessing();
     static void EndPostProcessing();
@@ -278,10 +329,35 @@ class Engine {
     static CPL::Shader &GetScreenQuadShader();
     static CPL::Shader &GetCubeMapShader();
     static CPL::Shader &GetDepthShader();
+    // Instanced particle shader of the current mode (lit in TEX_LIGHT)
+    static const CPL::Shader &GetParticleShader();
 
     static CPL::Texture2D *GetWhiteTex();
 
   private:
+    // Batch shaders of the current mode
+    static const CPL::Shader &GetShapeBatchShader();
+    static const CPL::Shader &GetSpriteBatchShader();
+    // Records the command if the draw queue is on, else draws it
+    static void SubmitDraw(const CPL::DrawCommand &command);
+    // Adds the command to its batch, flushing the other 2D batch to keep
+    // the order between sprites & shapes
+    static void ExecuteDraw(const CPL::DrawCommand &command);
+    // Sorts the draw queue & replays it into the batches
+    static void SubmitDrawQueue();
+    // Compiles every 3D shader variant SelectShaders3D can pick, so none is
+    // compiled in the middle of a frame
+    static void PrecompileShaders3D();
+    // Picks the cheapest 3D shader variants for the point light count, fog
+    // & shadows, rebinding the shader if the current mode uses it
+    static void SelectShaders3D();
+    // Shader for 3D shapes, the depth shader during a depth pass
+    static const CPL::Shader &GetShader3D();
+    // Draws with the SDF shader if the current font is one
+    static void DrawTextStyled(const glm::vec2 &pos, float scale,
+                               const std::string &text, const CPL::Color &color,
+                               const CPL::TextStyle &style);
+
     static uint32_t s_ScreenWidth;
     static uint32_t s_ScreenHeight;
     static glm::mat4 s_Projection2D;
@@ -291,13 +367,38 @@ class Engine {
 
     static CPL::Shader s_Shape2DShader;
     static CPL::Shader s_TextShader;
+    static CPL::Shader s_TextSDFShader;
     static CPL::Shader s_TextureShader;
     static CPL::Shader s_LightShape2DShader;
     static CPL::Shader s_LightTextureShader;
     static CPL::Shader s_ScreenShader;
-
-    static CPL::Shader s_Shape3DShader;
-    static CPL::Shader s_LightShape3DShader;
+    static CPL::Shader s_ShapeBatchShader;
+    static CPL::Shader s_LightShapeBatchShader;
+    static CPL::Shader s_SpriteBatchShader;
+    static CPL::Shader s_LightSpriteBatchShader;
+    static CPL::Shader s_ParticleShader;
+    static CPL::Shader s_LightParticleShader;
+
+    // Never built, the current variants point at it until SelectShaders3D
+    // picks one (web builds have no 3D shaders)
+    static CPL::Shader s_Missing3DShader;
+    // Current variants of the 3D shaders (see SelectShaders3D)
+    static CPL::Shader *s_Shape3DShader;
+    static CPL::Shader *s_LightShape3DShader;
+    static CPL::ShaderVariants s_Shape3DVariants;
+    static CPL::ShaderVariants s_LightShape3DVariants;
+    // Index: point light tier (0, 8, max) * 4 + shadows * 2 + fog
+    static std::array<CPL::Shader *, 12> s_LightShape3DTable;
+    // Index: fog
+    static std::array<CPL::Shader *, 2> s_Shape3DTable;
+    // Index of the selected light variant, -1 forces SelectShaders3D to pick
+    static int s_Selected3D;
+    static int s_NumPointLights3D;
+    static int s_ShadowFilter;
+    static bool s_FogEnabled;
+    static bool s_ShadowsEnabled;
+    static uint32_t s_ShadowUnit;
+    static glm::mat4 s_LightSpaceMatrix;
     static CPL::Shader s_CubeMapShader;
     static CPL::Shader s_DepthShader;
 
@@ -316,6 +417,15 @@ class Engine {
     static CPL::Camera2D s_Camera2D;
     static CPL::Camera3D s_Camera3D;
     static CPL::ScreenQuad s_ScreenQuad;
+    static CPL::ShapeBatch s_ShapeBatch;
+    static bool s_ShapeBatching;
+    static CPL::SpriteBatch s_SpriteBatch;
+    static bool s_SpriteBatching;
+    static CPL::InstanceBatch s_InstanceBatch;
+    static bool s_Instancing;
+    static CPL::DrawQueue s_DrawQueue;
+    static bool s_QueueDraws;
+    static bool s_DepthPass;
 
     static bool s_CharInputEnabled;
 
@@ -0,0 +1,89 @@
+#pragma once
+#include "CPL.h"
+#include <array>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+struct FT_FaceRec_;
+
+namespace CPL {
+struct Character {
+    // Position inside the glyph atlas (u0, v0, u1, v1)
+    glm::vec4 uvRect;
+    glm::ivec2 size;
+    glm::ivec2 bearing;
+    uint32_t advance;
+
+    Character(const glm::vec4 &uvRect, const glm::ivec2 &size,
+              const glm::ivec2 &bearing, const uint32_t advance)
+        : uvRect(uvRect), size(size), bearing(bearing), advance(advance) {}
+};
+
+// Glyphs of one font, rasterized with FreeType the first time they are
+// used into a fixed grid of cells inside one atlas texture. When the atlas
+// is full the least recently used glyph is replaced
+class GlyphCache {
+  public:
+    static constexpr int atlasSize = 1024;
+    // Pixels around every SDF glyph the distance is stored for
+    static constexpr int sdfSpread = 8;
+
+    // Takes ownership of face. SDF glyphs store the distance to the outline
+    // instead of coverage & are always filtered linearly
+    GlyphCache(FT_FaceRec_ *face, int pixelSize,
+               const TextureFiltering &textureFiltering,
+               const FontRendering &rendering);
+    ~GlyphCache();
+
+    GlyphCache(const GlyphCache &) = delete;
+    GlyphCache &operator=(const GlyphCache &) = delete;
+
+    // nullptr if the glyph could not be loaded or every cell is used by
+    // the current string
+    const Character *Get(uint32_t codepoint);
+    // Starts a new string, glyphs used after this are not replaced until
+    // the next call
+    void BeginUse() { m_Tick++; }
+
+    [[nodiscard]] uint32_t GetTexture() const { return m_Texture; }
+    // Bearing of 'H', used to align the top of the text with pos
+    [[nodiscard]] int GetCapHeight() const { return m_CapHeight; }
+    // Changes every time a glyph is replaced, so UVs built before are stale
+    [[nodiscard]] uint32_t GetGeneration() const { return m_Generation; }
+    // Padding of the glyph quads around the outline (0 for bitmap fonts)
+    [[nodiscard]] int GetSpread() const { return m_Spread; }
+
+  private:
+    static constexpr uint32_t s_PageSize = 256;
+    static constexpr uint32_t s_MaxCodepoint = 0x10FFFF;
+    using Page = std::array<int32_t, s_PageSize>;
+
+    struct Slot {
+        uint32_t codepoint = 0;
+        uint64_t lastUse = 0;
+        Character character{glm::vec4(0.0f), glm::ivec2(0), glm::ivec2(0),
+                            0};
+    };
+
+    FT_FaceRec_ *m_Face;
+    uint32_t m_Texture = 0;
+    glm::ivec2 m_CellSize{0};
+    int m_Columns = 0;
+    int m_CapHeight = 0;
+    int m_Spread = 0;
+    uint64_t m_Tick = 1;
+    uint32_t m_Generation = 0;
+
+    // Codepoint -> slot, split into pages of 256 codepoints that are only
+    // allocated once a glyph of them is used
+    std::vector<std::unique_ptr<Page>> m_Pages;
+    std::vector<Slot> m_Slots;
+    size_t m_UsedSlots = 0;
+    std::vector<uint8_t> m_CellPixels;
+
+    int32_t &m_Entry(uint32_t codepoint);
+    int32_t m_AllocateSlot();
+    bool m_Rasterize(uint32_t codepoint, Slot &slot, int32_t slotIndex);
+};
+} // namespace CPL
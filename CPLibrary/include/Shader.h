@@ -1,26 +1,61 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace CPL {
     struct Color;
 
+    // Location of a uniform, get it once with Shader::GetUniform and set it
+    // without any lookup. Only valid for the shader it was taken from
+    struct UniformHandle {
+        int32_t location = -1;
+
+        [[nodiscard]] bool IsValid() const { return location >= 0; }
+    };
+
     class Shader {
     public:
         Shader() = default;
-        Shader(const char* vertexPath, const char* fragmentPath);
+        // Every define ("USE_FOG", "MAX_POINT_LIGHTS 8") is added as a
+        // #define after the #version line of both stages
+        Shader(const char* vertexPath, const char* fragmentPath,
+               const std::vector<std::string> &defines = {});
 
         void Use() const;
         void SetBool(const std::string &name, bool value) const;
         void SetInt(const std::string &name, int value) const;
         void SetFloat(const std::string &name, float value) const;
         void SetColor(const std::string &name, const Color& color) const;
+        void SetMatrix3fv(const std::string &name, const glm::mat3& matrix) const;
         void SetMatrix4fv(const std::string &name, const glm::mat4& matrix) const;
 	    void SetVector2f(const std::string &name, const glm::vec2& vec2) const;
         void SetVector3f(const std::string &name, const glm::vec3& vec3) const;
+        void SetVector4f(const std::string &name, const glm::vec4& vec4) const;
+
+        // Invalid handle if the shader has no active uniform with this name
+        [[nodiscard]] UniformHandle GetUniform(const std::string &name) const;
+        void SetBool(UniformHandle handle, bool value) const;
+        void SetInt(UniformHandle handle, int value) const;
+        void SetFloat(UniformHandle handle, float value) const;
+        void SetColor(UniformHandle handle, const Color& color) const;
+        void SetMatrix3fv(UniformHandle handle, const glm::mat3& matrix) const;
+        void SetMatrix4fv(UniformHandle handle, const glm::mat4& matrix) const;
+        void SetVector2f(UniformHandle handle, const glm::vec2& vec2) const;
+        void SetVector3f(UniformHandle handle, const glm::vec3& vec3) const;
+        void SetVector4f(UniformHandle handle, const glm::vec4& vec4) const;
     private:
         uint32_t m_ID;
+        // Every active uniform after linking (array elements one by one)
+        std::unordered_map<std::string, int32_t> m_Uniforms;
+
+        void m_ReflectUniforms();
+        // Shared blocks (Camera, Lights2D etc.) to their UniformBlocks binding
+        void m_BindUniformBlocks() const;
+        static std::string m_AddDefines(const std::string &code,
+                                        const std::vector<std::string> &defines);
         static bool m_CheckCompileErrors(uint32_t shader, const std::string& type);
     };
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace CPL {
+// On-disk cache of linked programs (glGetProgramBinary). Files are named by
+// a hash of both sources & the GL vendor/renderer/version, so a driver
+// update or an edited shader is a miss & the shader is compiled again.
+// Needs GL 4.1 or GL_ARB_get_program_binary, else everything is a miss
+class ShaderCache {
+  public:
+    // Folder for the binaries (created on the first store), call before
+    // InitWindow to move it. Empty disables the cache
+    static void SetDirectory(const std::string &path);
+    [[nodiscard]] static const std::string &GetDirectory() {
+        return s_Directory;
+    }
+
+    [[nodiscard]] static bool IsSupported();
+
+    // Linked program from the cache, 0 on a miss or if the driver rejects
+    // the binary
+    static uint32_t Load(const std::string &vertexCode,
+                         const std::string &fragmentCode);
+    // Call before linking a program that will be stored
+    static void PrepareProgram(uint32_t program);
+    static void Store(uint32_t program, const std::string &vertexCode,
+                      const std::string &fragmentCode);
+
+  private:
+    static std::string s_Directory;
+    static int8_t s_Supported;
+
+    static uint64_t m_Hash(const std::string &text, uint64_t hash);
+    static const std::string &m_DriverID();
+    static std::string m_FilePath(const std::string &vertexCode,
+                                  const std::string &fragmentCode);
+};
+} // namespace CPL
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Shader.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CPL {
+// One shader source compiled with different #define sets, e.g. without the
+// point light loop or the shadow lookup. Variants are compiled on first use
+// & stay at the same address, so pointers to them remain valid
+class ShaderVariants {
+  public:
+    ShaderVariants() = default;
+    ShaderVariants(std::string vertexPath, std::string fragmentPath);
+
+    // Variant with these defines (order matters for the lookup)
+    Shader &Get(const std::vector<std::string> &defines);
+    [[nodiscard]] size_t GetCount() const { return m_Variants.size(); }
+
+  private:
+    std::string m_VertexPath;
+    std::string m_FragmentPath;
+    std::unordered_map<std::string, Shader> m_Variants;
+};
+} // namespace CPL
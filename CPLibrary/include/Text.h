@@ -1,35 +1,90 @@
 #pragma once
 #include "CPL.h"
+#include "Engine.h"
 #include "glad/glad.h"
 #include <glm/glm.hpp>
+#include <list>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FT_LibraryRec_;
 
 namespace CPL {
-struct Character {
-    uint32_t textureID;
-    glm::ivec2 size;
-    glm::ivec2 bearing;
-    uint32_t advance;
-
-    Character(const uint32_t id, const glm::ivec2 &size,
-              const glm::ivec2 &bearing, const uint32_t advance)
-        : textureID(id), size(size), bearing(bearing), advance(advance) {}
+class GlyphCache;
+class TextMesh;
+
+// Effects of SDF fonts, drawn by the shader in the same draw call as the
+// text. Ignored for bitmap fonts
+struct TextStyle {
+    Color outlineColor{0.0f};
+    // In pixels of the font at scale 1, at most GlyphCache::sdfSpread
+    float outlineWidth = 0.0f;
+    Color shadowColor{0.0f};
+    // In pixels on screen, limited to the spread at the drawn scale
+    glm::vec2 shadowOffset{0.0f};
 };
 
 class Text {
   public:
     static void Init(const std::string &fontPath, const std::string &fontName,
-                     const TextureFiltering &textureFiltering);
+                     const TextureFiltering &textureFiltering,
+                     const FontRendering &rendering = FontRendering::BITMAP);
     static void Use(const std::string &fontName);
+    // text is UTF-8
     static void DrawText(const Shader &shader, const std::string &text,
-                         glm::vec2 pos, float scale, const Color &color);
+                         glm::vec2 pos, float scale, const Color &color,
+                         const TextStyle &style = {});
+    // SDF fonts need the shader of GetTextSDFShader()
+    static bool IsSDF(const std::string &fontName);
+    static const std::string &GetCurFont() { return s_CurFont; }
     static glm::vec2 GetTextSize(const std::string &fontName,
                                  const std::string &text, float scale);
 
+    // Writes the quads (pos + uv) of the text at scale 1 with the top left
+    // corner at (0, 0). Returns the atlas texture of the font (0 if the
+    // font does not exist), size is the same as GetTextSize
+    static uint32_t BuildVertices(const std::string &fontName,
+                                  const std::string &text,
+                                  std::vector<float> &vertices,
+                                  glm::vec2 &size);
+    // Changes when glyphs of the font were replaced in its atlas
+    static uint32_t GetGeneration(const std::string &fontName);
+    // Pixels the quads of a SDF font extend around the outline, 0 for
+    // bitmap fonts
+    static int GetSpread(const std::string &fontName);
+
+    // Amount of strings DrawText keeps as TextMesh, least recently drawn
+    // ones are replaced first
+    static void SetCacheCapacity(size_t capacity);
+    static void ClearCache();
+    // Frees all fonts (called by CloseWindow)
+    static void Shutdown();
+
+    // Reads the codepoint starting at text[i] & moves i behind it,
+    // invalid bytes become U+FFFD
+    static uint32_t DecodeUTF8(const std::string &text, size_t &i);
+    // f.e. to append GetCharPressed() to a string
+    static std::string EncodeUTF8(uint32_t codepoint);
+
   private:
-    static std::map<std::string, std::map<GLchar, Character>> s_Fonts;
-    static uint32_t s_VAO, s_VBO;
+    using CacheList = std::list<TextMesh>;
+
+    static FT_LibraryRec_ *s_FreeType;
+    static std::map<std::string, std::unique_ptr<GlyphCache>> s_Fonts;
     static std::string s_CurFont;
+
+    static CacheList s_Cache;
+    // Font name, then text, so a hit looks up the caller's strings without
+    // building a combined key
+    static std::unordered_map<
+        std::string, std::unordered_map<std::string, CacheList::iterator>>
+        s_CacheLookup;
+    static size_t s_CacheCapacity;
+
+    static TextMesh &m_GetCachedMesh(const std::string &fontName,
+                                     const std::string &text);
 };
 } // namespace CPL
@@ -0,0 +1,83 @@
+#pragma once
+#include "CPL.h"
+#include "Text.h"
+#include <glm/glm.hpp>
+#include <string>
+
+namespace CPL {
+struct Color;
+class Shader;
+
+// A string laid out once into its own vertex buffer. Drawing it again only
+// sets the position/scale/color uniforms & issues one draw call, so use it
+// for text that does not change every frame (DrawText caches these too)
+class TextMesh {
+  public:
+    TextMesh(const std::string &fontName, const std::string &text);
+    ~TextMesh();
+
+    TextMesh(const TextMesh &) = delete;
+    TextMesh &operator=(const TextMesh &) = delete;
+
+    TextMesh(TextMesh &&other) noexcept
+        : m_VAO(other.m_VAO), m_VBO(other.m_VBO),
+          m_BufferSize(other.m_BufferSize), m_VertexCount(other.m_VertexCount),
+          m_Texture(other.m_Texture), m_Generation(other.m_Generation),
+          m_Spread(other.m_Spread), m_Size(other.m_Size),
+          m_Font(std::move(other.m_Font)), m_Text(std::move(other.m_Text)) {
+        other.m_VAO = 0;
+        other.m_VBO = 0;
+        other.m_BufferSize = 0;
+        other.m_VertexCount = 0;
+    }
+
+    TextMesh &operator=(TextMesh &&other) noexcept {
+        if (this != &other) {
+            m_Unload();
+
+            m_VAO = other.m_VAO;
+            m_VBO = other.m_VBO;
+            m_BufferSize = other.m_BufferSize;
+            m_VertexCount = other.m_VertexCount;
+            m_Texture = other.m_Texture;
+            m_Generation = other.m_Generation;
+            m_Spread = other.m_Spread;
+            m_Size = other.m_Size;
+            m_Font = std::move(other.m_Font);
+            m_Text = std::move(other.m_Text);
+
+            other.m_VAO = 0;
+            other.m_VBO = 0;
+            other.m_BufferSize = 0;
+            other.m_VertexCount = 0;
+        }
+        return *this;
+    }
+
+    // Lays the text out again, reusing the vertex buffer
+    void SetText(const std::string &fontName, const std::string &text);
+    // pos is the top left corner like DrawText. Lays the text out again if
+    // glyphs of its font were replaced in the atlas since the last time.
+    // style is only used by SDF fonts (with GetTextSDFShader())
+    void Draw(const Shader &shader, const glm::vec2 &pos, float scale,
+              const Color &color, const TextStyle &style = {});
+
+    // Same as Text::GetTextSize with scale 1
+    [[nodiscard]] glm::vec2 GetSize() const { return m_Size; }
+    [[nodiscard]] const std::string &GetText() const { return m_Text; }
+    [[nodiscard]] const std::string &GetFont() const { return m_Font; }
+
+  private:
+    uint32_t m_VAO{}, m_VBO{};
+    size_t m_BufferSize = 0;
+    int m_VertexCount = 0;
+    uint32_t m_Texture = 0;
+    uint32_t m_Generation = 0;
+    int m_Spread = 0;
+    glm::vec2 m_Size{0.0f};
+    std::string m_Font;
+    std::string m_Text;
+
+    void m_Unload() const;
+};
+} // namespace CPL
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CPL.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace CPL {
+class GlobalLight;
+class PointLight;
+class PointLight3D;
+class DirectionalLight;
+
+// std140 uniform blocks shared by every shader. A Shader binds the blocks it
+// declares to these binding points after linking, so camera, lights & fog
+// are written once into one buffer each without switching programs
+class UniformBlocks {
+  public:
+    // Binding point of each block, same order as blockNames
+    enum class Binding : uint8_t { CAMERA, LIGHTS_2D, LIGHTS_3D, FOG };
+    // Block names in the shaders
+    static constexpr std::array<const char *, 4> blockNames = {
+        "Camera", "Lights2D", "Lights3D", "Fog"};
+    // Size of the point light arrays in the shaders
+    static constexpr int maxPointLights = 32;
+
+    // Layouts of the blocks (std140)
+    struct Camera {
+        // Projection of the current BeginDraw (2D or 3D camera)
+        glm::mat4 projection{1.0f};
+        glm::vec3 viewPos{0.0f};
+        float padding = 0;
+    };
+    struct PointLight2DData {
+        glm::vec2 position;
+        float radius;
+        float intensity;
+        glm::vec4 color;
+    };
+    struct Lights2D {
+        float globalIntensity = 0;
+        float padding0[3]{};
+        glm::vec4 globalColor{0.0f};
+        float ambient = 0;
+        int32_t numPointLights = 0;
+        float padding1[2]{};
+        std::array<PointLight2DData, maxPointLights> pointLights{};
+    };
+    struct PointLight3DData {
+        glm::vec3 position;
+        float padding;
+        glm::vec4 color;
+        float intensity;
+        float constant;
+        float linear;
+        float quadratic;
+    };
+    struct Lights3D {
+        // vec3s of the directional light are padded to vec4
+        glm::vec4 dirDirection{0.0f};
+        glm::vec4 dirAmbient{0.0f};
+        glm::vec4 dirDiffuse{0.0f};
+        glm::vec4 dirSpecular{0.0f};
+        float shininess = 32;
+        int32_t numPointLights = 0;
+        float padding[2]{};
+        std::array<PointLight3DData, maxPointLights> pointLights{};
+    };
+    struct Fog {
+        glm::vec4 color{0.0f};
+        float start = 0;
+        float end = 0;
+        // bool is 4 bytes in std140
+        int32_t enabled = 0;
+        float padding = 0;
+    };
+
+    static void Init();
+    static void Destroy();
+
+    // Binding point of a shared block, -1 for other blocks
+    static int GetBinding(const std::string &blockName);
+
+    static void SetCamera(const glm::mat4 &projection,
+                          const glm::vec3 &viewPos);
+    // Camera of the current BeginDraw
+    [[nodiscard]] static const Camera &GetCamera() { return s_Camera; }
+
+    static void SetAmbientLight2D(float strength);
+    static void SetGlobalLight2D(const GlobalLight &light);
+    // Lights past maxPointLights are ignored
+    static void SetPointLights2D(const std::vector<PointLight> &lights);
+
+    static void SetShininess3D(float shininess);
+    static void SetDirLight3D(const DirectionalLight &light);
+    // Lights past maxPointLights are ignored
+    static void SetPointLights3D(const std::vector<PointLight3D> &lights);
+
+    static void EnableFog(bool enabled);
+    static void SetFog(float fogStart, float fogEnd, const Color &color);
+
+  private:
+    static std::array<uint32_t, blockNames.size()> s_UBOs;
+    static Camera s_Camera;
+    static Lights2D s_Lights2D;
+    static Lights3D s_Lights3D;
+    static Fog s_Fog;
+
+    // One glBufferSubData of the bytes [offset, offset + size) of data
+    static void m_Upload(Binding binding, const void *data, size_t offset,
+                         size_t size);
+};
+} // namespace CPL
@@ -5,35 +5,214 @@
 
 namespace CPL {
 class Texture2D;
+class ThreadPool;
+class Tilemap;
+
+// What a particle does when it hits a tile or leaves the bounds
+enum class ParticleCollision : uint8_t {
+    NONE,
+    // Reflects the velocity on the axis it hit (times bounciness)
+    BOUNCE,
+    // Stops where it hit
+    STICK,
+    KILL,
+};
+
+// Describes how a ParticleSystem spawns & animates particles. Curve keys
+// are sorted by time (0 = spawn, 1 = end of the lifetime) & are baked into
+// lookup tables by ParticleSystem::SetEmitter
+struct ParticleEmitter {
+    template <typename T> struct Key {
+        float time;
+        T value;
+    };
+
+    Texture2D *tex = nullptr;
+    // Particles per second spawned by ParticleSystem::Update
+    float rate = 0;
+    // Particles spawn inside this rectangle centered on the system position
+    glm::vec2 area{0.0f};
+    float minLifeTime = 1, maxLifeTime = 1;
+    float minSpeed = 50, maxSpeed = 50;
+    // Rotation at spawn & rotation per second, in degrees
+    float minRotation = 0, maxRotation = 0;
+    float minSpin = 0, maxSpin = 0;
+    // Direction in radians & the half angle of the cone around it
+    float angle = 0;
+    float spread = 3.14159265f;
+    glm::vec2 gravity{0.0f};
+    // Part of the velocity lost per second
+    float drag = 0;
+    Color color{255};
+    // Multiplies color, empty is white
+    std::vector<Key<Color>> colorCurve;
+    // Multiplies the texture size, empty is 1
+    std::vector<Key<float>> sizeCurve;
+};
+
+// Fixed size pool of particles stored as one array per attribute, so Update
+// moves & fades several particles per instruction (see util/Simd.h) and
+// nothing is allocated after the constructor. A dead particle is replaced
+// by the last one, so particles don't keep their order.
+// Draw streams one Instance per particle into a buffer & draws every texture
+// with one instanced draw, the quads are built in the vertex shader
 class ParticleSystem {
   public:
+    // Per particle data on the GPU, 20 bytes
+    struct Instance {
+        // Top left corner like DrawTex2D
+        glm::vec2 pos;
+        // Scale of the texture size
+        float size;
+        // Degrees
+        float angle;
+        // RGBA8
+        uint32_t color;
+    };
+
     glm::vec2 pos;
+    // False draws every particle through the sprite batch (DrawTex2DRot)
+    bool instanced = true;
+    // Sprite batch layer the particles are drawn on if not instanced
+    int layer = 0;
+    // Alpha goes from the spawn color to 0 over the lifetime
+    bool fadeOut = false;
+
+    // Checked in Update at the center of every particle with one grid lookup
+    // of the tilemap (all tiles are solid) & against the bounds (ignored
+    // while boundsMax <= boundsMin, e.g. {0, 0} to the screen size)
+    ParticleCollision collision = ParticleCollision::NONE;
+    // Part of the velocity kept when bouncing
+    float bounciness = 0.5f;
+    // Has to outlive the system & must not change during UpdateParallel
+    const Tilemap *tilemap = nullptr;
+    glm::vec2 boundsMin{0.0f};
+    glm::vec2 boundsMax{0.0f};
+
+    ParticleSystem(const glm::vec2 &pos, uint32_t capacity = 10000);
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem &) = delete;
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+    ParticleSystem(ParticleSystem &&other) noexcept;
+    ParticleSystem &operator=(ParticleSystem &&other) noexcept;
 
-    ParticleSystem(const glm::vec2 &pos) : pos(pos) {}
     void Update();
+    // Updates all systems on the worker pool (shared pool if none is given),
+    // systems with many particles are split into ranges of parallelRange.
+    // Same result as calling Update on each, no matter how many threads run
+    static void UpdateParallel(const std::vector<ParticleSystem *> &systems);
+    static void UpdateParallel(const std::vector<ParticleSystem *> &systems,
+                               ThreadPool &pool);
+    // Instanced: draws right away in BeginDraw(TEX) or BeginDraw(TEX_LIGHT)
+    // after flushing the batches, so particles are on top of what was drawn
+    // before
     void Draw();
-    void AddParticle(Texture2D *tex, const Color &color, float lifeTime,
+    // False if the pool is full
+    bool AddParticle(Texture2D *tex, const Color &color, float lifeTime,
                      const glm::vec2 &dir, const glm::vec2 &off);
+    void Clear() { m_Count = 0; }
 
-    struct Particle {
-        glm::vec2 pos;
-        float curLifeTime = 0;
-        float lifeTime;
-        glm::vec2 dir;
-        bool active = true;
-        Texture2D *particleTex;
-        Color color;
-
-        Particle(const glm::vec2 &pos, Texture2D *const tex, const Color &color,
-                 const float lifeTime, const glm::vec2 &dir)
-            : pos(pos), lifeTime(lifeTime), dir(dir), particleTex(tex),
-              color(color) {}
-        void Update() {
-            curLifeTime += GetDeltaTime();
-            pos += dir * glm::vec2(GetDeltaTime());
-        }
+    // Bakes the curves, following Update calls spawn emitter.rate particles
+    // per second & apply gravity & drag to all particles
+    void SetEmitter(const ParticleEmitter &emitter);
+    [[nodiscard]] const ParticleEmitter &GetEmitter() const {
+        return m_Emitter;
+    }
+    // Spawns count particles of the emitter at once (burst), returns the
+    // amount that fit into the pool
+    uint32_t Emit(uint32_t count);
+    void SetSeed(uint32_t seed);
+
+    [[nodiscard]] uint32_t GetCount() const { return m_Count; }
+    [[nodiscard]] uint32_t GetCapacity() const { return m_Capacity; }
+    [[nodiscard]] glm::vec2 GetParticlePos(const uint32_t index) const {
+        return {m_PosX[index], m_PosY[index]};
+    }
+    // Color with fading applied, RGBA8 (see Color::Pack)
+    [[nodiscard]] uint32_t GetParticleColor(const uint32_t index) const {
+        return m_Color[index];
+    }
+    // Scale of the texture size from the size curve
+    [[nodiscard]] float GetParticleSize(const uint32_t index) const {
+        return m_Size[index];
+    }
+    [[nodiscard]] float GetParticleAngle(const uint32_t index) const {
+        return m_Angle[index];
+    }
+
+    // Samples per baked curve
+    static constexpr uint32_t curveSamples = 64;
+    // Particles per task of UpdateParallel
+    static constexpr uint32_t parallelRange = 16384;
+
+  private:
+    uint32_t m_Count = 0;
+    uint32_t m_Capacity;
+    // Arrays are padded to a multiple of Simd::width so the last particles
+    // are updated without a scalar tail loop
+    std::vector<float> m_PosX, m_PosY;
+    std::vector<float> m_VelX, m_VelY;
+    std::vector<float> m_Age, m_LifeTime;
+    std::vector<uint32_t> m_SpawnColor, m_Color;
+    std::vector<float> m_Size;
+    std::vector<float> m_Angle, m_Spin;
+    // Index in m_Textures
+    std::vector<uint16_t> m_Texture;
+    std::vector<Texture2D *> m_Textures;
+    // Particles that died in the current Update, ascending, one list per
+    // range of UpdateParallel
+    std::vector<std::vector<uint32_t>> m_Dead;
+    uint32_t m_Ranges = 1;
+
+    ParticleEmitter m_Emitter;
+    std::array<uint32_t, curveSamples> m_ColorCurve{};
+    std::array<float, curveSamples> m_SizeCurve{};
+    // False while both curves are constant 1, Update skips them then
+    bool m_UseCurves = false;
+    // Emitter spins particles, Update skips the rotation otherwise
+    bool m_Spinning = false;
+    // Fractional particles of emitter.rate carried to the next Update
+    float m_SpawnDebt = 0;
+    uint32_t m_Random;
+
+    uint32_t m_VAO = 0, m_VBO = 0;
+    // Instances grouped by texture, rebuilt by every Draw
+    std::vector<Instance> m_Instances;
+    // First instance of every texture & one past the last
+    std::vector<uint32_t> m_TextureStarts;
+    std::vector<uint32_t> m_TextureEnds;
+
+    // Moves, fades & finds the dead particles of [first, end)
+    void m_Simulate(uint32_t first, uint32_t end, float deltaTime,
+                    std::vector<uint32_t> &dead);
+    // Tilemap cells looked up during one range of Update, particles close
+    // to each other share the grid lookup. Only used if all tiles have the
+    // same size. Indexed by the low bits of the cell, so cells of any
+    // 64 x 64 window don't replace each other
+    struct CellCache {
+        static constexpr int bits = 6;
+        struct Entry {
+            glm::ivec2 cell;
+            bool solid = false;
+            bool used = false;
+        };
+        glm::vec2 tileSize{0.0f};
+        glm::vec2 invTileSize{0.0f};
+        std::array<Entry, 1 << (2 * bits)> entries{};
     };
 
-    std::vector<Particle> particles;
+    // Collision of the particles in [first, end) that Update just moved,
+    // cache is null if the tiles have different sizes
+    void m_Collide(uint32_t first, uint32_t end, float deltaTime,
+                   CellCache *cache);
+    // Removes the dead particles & spawns new ones of the emitter
+    void m_Finish(float deltaTime);
+    void m_Remove(uint32_t index);
+    void m_DrawInstanced();
+    void m_DrawBatched();
+    void m_DeleteBuffers();
+    // Index in m_Textures, -1 if there are too many textures
+    int m_TextureIndex(Texture2D *tex);
 };
 } // namespace CPL
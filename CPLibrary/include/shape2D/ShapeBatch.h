@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../CPL.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace CPL {
+struct Color;
+class Shader;
+
+// Collects the immediate mode 2D shapes (DrawRect, DrawCircle etc.) as
+// already transformed vertices and draws them with as few draw calls as
+// possible instead of creating one VAO/VBO pair per shape
+class ShapeBatch {
+  public:
+    enum class Primitive : uint8_t {
+        TRIANGLES,
+        LINES,
+    };
+
+    struct Vertex {
+        glm::vec2 pos;
+        uint32_t color;
+    };
+
+    ShapeBatch() = default;
+    ~ShapeBatch();
+
+    ShapeBatch(const ShapeBatch &) = delete;
+    ShapeBatch &operator=(const ShapeBatch &) = delete;
+
+    // maxVertices is the amount of vertices after which the batch flushes
+    void Init(uint32_t maxVertices);
+
+    void AddRect(const Shader &shader, const glm::vec2 &pos,
+                 const glm::vec2 &size, float angle, const Color &color,
+                 bool filled);
+    void AddTriangle(const Shader &shader, const glm::vec2 &pos,
+                     const glm::vec2 &size, float angle, const Color &color,
+                     bool filled);
+    void AddCircle(const Shader &shader, const glm::vec2 &pos, float radius,
+                   const Color &color, bool filled);
+    void AddLine(const Shader &shader, const glm::vec2 &startPos,
+                 const glm::vec2 &endPos, const Color &color);
+
+    // Draws everything collected so far (binds the batch shader)
+    void Flush();
+    [[nodiscard]] bool IsEmpty() const { return m_Vertices.empty(); }
+    [[nodiscard]] uint32_t GetDrawCalls() const { return m_DrawCalls; }
+    void ResetDrawCalls() { m_DrawCalls = 0; }
+
+  private:
+    uint32_t m_VAO{}, m_VBO{};
+    uint32_t m_MaxVertices = 0;
+    uint32_t m_DrawCalls = 0;
+    const Shader *m_Shader = nullptr;
+    Primitive m_Primitive = Primitive::TRIANGLES;
+    std::vector<Vertex> m_Vertices;
+
+    Vertex *m_Reserve(const Shader &shader, Primitive primitive,
+                      uint32_t count);
+};
+} // namespace CPL
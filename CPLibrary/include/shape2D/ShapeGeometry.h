@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../CPL.h"
+#include <array>
+
+namespace CPL {
+// Unit meshes shared by every retained Rectangle, Triangle & Circle.
+// The shapes only store pos/size/color and scale these in their transform
+// so creating or resizing a shape does not touch the GPU
+class ShapeGeometry {
+  public:
+    // Circle resolutions, a circle uses the first one with at least
+    // ceil(radius) segments
+    static constexpr std::array<uint32_t, 6> circleLODs = {8,  16,  32,
+                                                           64, 128, 256};
+
+    static void Init();
+    static void Destroy();
+
+    // (0, 0) to (1, 1)
+    static void DrawQuad(bool filled);
+    // (0, 0), (1, 0), (0.5, 1)
+    static void DrawTriangle(bool filled);
+    // Radius 1 around (0, 0), radius only picks the LOD
+    static void DrawCircle(float radius, bool filled);
+
+    static uint32_t GetCircleSegments(float radius);
+
+  private:
+    struct Mesh {
+        int first = 0;
+        int count = 0;
+    };
+
+    static uint32_t s_VAO, s_VBO;
+    static Mesh s_Quad, s_Triangle;
+    static std::array<Mesh, circleLODs.size()> s_Circles;
+
+    static size_t m_GetCircleLOD(float radius);
+};
+} // namespace CPL
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../CPL.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace CPL {
+struct Color;
+class Shader;
+
+// Collects textured quads (DrawTex2D, DrawTex2DRot, particles) and draws
+// them with one draw call per texture run. Sprites are sorted by layer
+// (lower layers are drawn first) & keep submission order inside a layer.
+// With SetSortByTexture they are also grouped by texture inside a layer,
+// fewer draw calls but overlapping sprites of different textures may swap
+class SpriteBatch {
+  public:
+    struct Vertex {
+        glm::vec2 pos;
+        glm::vec2 uv;
+        uint32_t color;
+    };
+
+    SpriteBatch() = default;
+    ~SpriteBatch();
+
+    SpriteBatch(const SpriteBatch &) = delete;
+    SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+    // maxSprites is the amount of sprites after which the batch flushes
+    void Init(uint32_t maxSprites);
+
+    // uvRect is (u0, v0, u1, v1), {0, 0, 1, 1} draws the whole texture
+    void Add(const Shader &shader, uint32_t texture, int layer,
+             const glm::vec2 &pos, const glm::vec2 &size, float angle,
+             const glm::vec4 &uvRect, const Color &color);
+
+    // Sorts & draws everything collected so far (binds the batch shader)
+    void Flush();
+    [[nodiscard]] bool IsEmpty() const { return m_Sprites.empty(); }
+    [[nodiscard]] uint32_t GetDrawCalls() const { return m_DrawCalls; }
+    void ResetDrawCalls() { m_DrawCalls = 0; }
+
+    // Flushes first, off by default
+    void SetSortByTexture(bool enabled);
+    [[nodiscard]] bool GetSortByTexture() const { return m_SortByTexture; }
+
+    static uint64_t MakeSortKey(int layer, uint32_t texture, bool byTexture);
+
+  private:
+    struct Sprite {
+        uint64_t key;
+        uint32_t texture;
+        // First of the 4 vertices in m_Vertices
+        uint32_t first;
+    };
+
+    uint32_t m_VAO{}, m_VBO{}, m_EBO{};
+    uint32_t m_MaxSprites = 0;
+    uint32_t m_DrawCalls = 0;
+    bool m_SortByTexture = false;
+    const Shader *m_Shader = nullptr;
+    std::vector<Sprite> m_Sprites;
+    // 4 vertices per sprite in submission order
+    std::vector<Vertex> m_Vertices;
+    // m_Vertices in draw order (BatchBuffer::SortItems)
+    std::vector<Vertex> m_Sorted;
+};
+} // namespace CPL
@@ -14,12 +14,18 @@ class Texture2D {
     float rotAngle = 0;
     Color color;
     uint32_t tex{};
+    // Part of tex that is drawn (u0, v0, u1, v1)
+    glm::vec4 uvRect{0.0f, 0.0f, 1.0f, 1.0f};
 
     explicit Texture2D(const std::string &filePath, const glm::vec2 &size,
                        const TextureFiltering &textureFiltering);
     Texture2D(const std::string &filePath, const glm::vec2 &pos,
               const glm::vec2 &size, const Color &color,
               const TextureFiltering &textureFiltering);
+    // Sub texture of an already loaded texture (f.e. a TextureAtlas page),
+    // the texture is not deleted with this object
+    Texture2D(uint32_t texture, const glm::vec4 &uvRect,
+              const glm::vec2 &textureSize);
     ~Texture2D() { m_Unload(); }
 
     Texture2D(const Texture2D &) = delete;
@@ -28,7 +34,8 @@ class Texture2D {
     Texture2D(Texture2D &&other) noexcept
         : pos(other.pos), size(other.size), textureSize(other.textureSize),
           rotAngle(other.rotAngle), color(other.color), m_VBO(other.m_VBO),
-          m_VAO(other.m_VAO), m_EBO(other.m_EBO), tex(other.tex) {
+          m_VAO(other.m_VAO), m_EBO(other.m_EBO), tex(other.tex),
+          uvRect(other.uvRect), m_OwnsTexture(other.m_OwnsTexture) {
         other.m_VBO = 0;
         other.m_VAO = 0;
         other.m_EBO = 0;
@@ -48,6 +55,8 @@ class Texture2D {
             m_VAO = other.m_VAO;
             m_EBO = other.m_EBO;
             tex = other.tex;
+            uvRect = other.uvRect;
+            m_OwnsTexture = other.m_OwnsTexture;
 
             other.m_VBO = 0;
             other.m_VAO = 0;
@@ -61,7 +70,9 @@ class Texture2D {
 
   private:
     uint32_t m_VBO{}, m_VAO{}, m_EBO{};
+    bool m_OwnsTexture = true;
 
+    void m_CreateQuad();
     void m_Load(const std::string &filePath, const TextureFiltering &textureFiltering);
     void m_Unload() const;
 };
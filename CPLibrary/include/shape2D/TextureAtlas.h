@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../CPL.h"
+#include "Texture2D.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CPL {
+// Packs many images into a few large textures (pages) so sprites, tiles &
+// particles using them end up in the same sprite batch run / tile batch.
+// The returned Texture2D handles only reference a part of a page & work
+// with DrawTex2D, Tilemap::AddTile & ParticleSystem::AddParticle
+class TextureAtlas {
+  public:
+    // padding is the amount of pixels around every image, filled with the
+    // image border to avoid bleeding when filtering
+    explicit TextureAtlas(const glm::ivec2 &pageSize = {2048, 2048},
+                          int padding = 2,
+                          const TextureFiltering &textureFiltering =
+                              TextureFiltering::NEAREST);
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    // Queue an image file, returns false if it could not be loaded
+    bool Add(const std::string &name, const std::string &filePath);
+    // Queue already decoded RGBA8 pixels (rows from top to bottom)
+    bool AddPixels(const std::string &name, const uint8_t *pixels,
+                   const glm::ivec2 &size);
+    // Packs every queued image & uploads the changed pages. Can be called
+    // again after adding more images, existing handles stay valid
+    void Build();
+
+    // nullptr if no image with this name was built
+    [[nodiscard]] Texture2D *Get(const std::string &name);
+    [[nodiscard]] size_t GetPageCount() const { return m_Pages.size(); }
+    [[nodiscard]] uint32_t GetPageTexture(size_t page) const;
+
+  private:
+    struct SkylineNode {
+        int x, y, width;
+    };
+    struct Page {
+        std::vector<uint8_t> pixels;
+        std::vector<SkylineNode> skyline;
+        uint32_t tex = 0;
+        bool dirty = false;
+    };
+    struct PendingImage {
+        std::string name;
+        glm::ivec2 size;
+        // Bottom row first like the other textures (flipped on load)
+        std::vector<uint8_t> pixels;
+    };
+
+    glm::ivec2 m_PageSize;
+    int m_Padding;
+    TextureFiltering m_Filtering;
+    std::vector<Page> m_Pages;
+    std::vector<PendingImage> m_Pending;
+    std::unordered_map<std::string, Texture2D> m_Textures;
+
+    bool m_FindPosition(const Page &page, const glm::ivec2 &size,
+                        glm::ivec2 &pos, size_t &nodeIndex) const;
+    void m_InsertSkyline(Page &page, size_t nodeIndex, const glm::ivec2 &pos,
+                         const glm::ivec2 &size) const;
+    void m_CopyPadded(Page &page, const PendingImage &image,
+                      const glm::ivec2 &pos) const;
+    void m_Upload(Page &page) const;
+};
+} // namespace CPL
@@ -1,22 +1,49 @@
 #pragma once
 #include "../CPL.h"
+#include "../util/MappedFile.h"
+#include <string>
 #include <vector>
 
 namespace CPL {
 class Shader;
 class Texture2D;
 
+// Tiles are grouped into square chunks of chunkSize world units. Every chunk
+// has its own static vertex buffer that is only uploaded again after
+// AddTile/DeleteTile changed it, and only chunks inside the view of the
+// current BeginDraw are drawn.
+// Tiles are indexed by the nearest cell of a grid of their own size
+// (pos / size), so lookups, adds & deletes only look at the tiles of one
+// cell. Tiles can be off the grid & several tiles can stack on one cell
 class Tilemap {
   public:
+    // Vertices of one texture inside a chunk
     struct TileBatch {
         std::vector<float> vertices;
+        // Index in tiles of every quad in vertices
+        std::vector<uint32_t> owners;
+        // Position in the chunk buffer of the last upload
+        uint32_t first = 0;
+    };
+    struct Chunk {
+        std::unordered_map<uint32_t, TileBatch> batches;
+        // Bounds of the tiles (tiles can reach into the next chunk)
+        glm::vec2 min{0.0f};
+        glm::vec2 max{0.0f};
+        uint32_t VAO = 0;
         uint32_t VBO = 0;
+        // Size of the buffer in floats
+        size_t capacity = 0;
+        bool dirty = true;
     };
     struct Tile {
         Tile(const glm::vec2 pos, const glm::vec2 size)
             : pos(pos), size(size) {}
         glm::vec2 pos;
         glm::vec2 size;
+        uint32_t texture = 0;
+        // Part of the texture, see Texture2D::uvRect
+        glm::vec4 uvRect{0.0f, 0.0f, 1.0f, 1.0f};
         bool isCollidable = false;
 
         bool operator==(const Tile &other) const {
@@ -24,19 +51,191 @@ class Tilemap {
         }
     };
 
+    // Read only, deleting a tile moves the last tile into its place
     std::vector<Tile> tiles;
-    std::unordered_map<uint32_t, TileBatch> batches;
+    std::unordered_map<uint64_t, Chunk> chunks;
+
+    explicit Tilemap(float chunkSize = 2048.0f);
+    ~Tilemap();
 
-    Tilemap();
+    Tilemap(const Tilemap &) = delete;
+    Tilemap &operator=(const Tilemap &) = delete;
+    Tilemap(Tilemap &&other) noexcept;
+    Tilemap &operator=(Tilemap &&other) noexcept;
+
+    // Removes the drawn quads, tiles stay until deleted. AddTile of a tile
+    // that is already there draws it again
     void BeginEditing();
     void AddTile(const glm::vec2 &pos, const glm::vec2 &size, const Texture2D *tex);
     void DeleteTile(const glm::vec2 &pos, const glm::vec2 &size,
                     const Texture2D * tex);
-    bool TileExist(const glm::vec2 &pos, const glm::vec2 &size);
+    bool TileExist(const glm::vec2 &pos, const glm::vec2 &size) const;
+    // Index in tiles of the first tile at exactly pos, -1 if there is none
+    [[nodiscard]] int FindTile(const glm::vec2 &pos,
+                               const glm::vec2 &size) const;
     void CheckCollidableTiles(const glm::vec2 &size);
     void Draw();
 
+    struct RaycastHit {
+        // Index in tiles, -1 if nothing was hit
+        int tile = -1;
+        glm::vec2 point{0.0f};
+        // Side of the tile that was hit, (0, 0) if start is inside it
+        glm::vec2 normal{0.0f};
+        float distance = 0;
+    };
+
+    // Collidable tiles overlapping the shape, looked up by grid cell so the
+    // cost grows with the covered area and not with the tile count.
+    // result is cleared first, reuse it to avoid allocations
+    void QueryRect(const glm::vec2 &pos, const glm::vec2 &size,
+                   std::vector<uint32_t> &result) const;
+    void QueryCircle(const glm::vec2 &center, float radius,
+                     std::vector<uint32_t> &result) const;
+    // Cells the segment passes through (DDA), in order from start to end
+    // if all tiles have the same size. Not thread safe (see m_Visited)
+    void QuerySegment(const glm::vec2 &start, const glm::vec2 &end,
+                      std::vector<uint32_t> &result) const;
+    // First collidable tile between start & end
+    [[nodiscard]] RaycastHit Raycast(const glm::vec2 &start,
+                                     const glm::vec2 &end) const;
+    // Index in tiles of any tile (collidable or not) covering the point,
+    // -1 if none. One grid lookup per tile size in use
+    [[nodiscard]] int TileAt(const glm::vec2 &point) const;
+
+    // Binary level file (see FileHeader). textures[i] is the texture or
+    // TextureAtlas handle stored as id i, every tile has to use one of them
+    bool Save(const std::string &filePath,
+              const std::vector<const Texture2D *> &textures) const;
+    // Clears the tilemap & memory maps the file, tiles are only added by
+    // StreamChunks. The textures have to stay alive while streaming
+    bool Open(const std::string &filePath,
+              const std::vector<const Texture2D *> &textures);
+    // Adds the chunks of the opened file that overlap the rectangle & are
+    // not added yet, returns the amount of chunks added
+    uint32_t StreamChunks(const glm::vec2 &min, const glm::vec2 &max);
+    // Open & StreamChunks of the whole file
+    bool Load(const std::string &filePath,
+              const std::vector<const Texture2D *> &textures);
+
+    [[nodiscard]] float GetChunkSize() const { return m_ChunkSize; }
+    // Size shared by all tiles, {0, 0} if there are none, sizes differ or
+    // tiles are off the grid
+    [[nodiscard]] glm::vec2 GetTileSize() const {
+        return m_Sizes.size() == 1 && m_Sizes[0].offGrid == 0
+                   ? m_Sizes[0].size
+                   : glm::vec2(0.0f);
+    }
+    // Chunks drawn by the last Draw call
+    [[nodiscard]] uint32_t GetDrawnChunks() const { return m_DrawnChunks; }
+
   private:
-    uint32_t m_VAO{};
+    // Grid cell & size of a tile
+    struct TileKey {
+        glm::ivec2 cell;
+        glm::vec2 size;
+
+        bool operator==(const TileKey &other) const {
+            return cell == other.cell && size == other.size;
+        }
+    };
+    struct TileKeyHash {
+        size_t operator()(const TileKey &key) const;
+    };
+    // End of a cell & quad of a tile that is not drawn
+    static constexpr uint32_t noTile = UINT32_MAX;
+    static constexpr uint32_t noQuad = UINT32_MAX;
+    // Entry of the open addressing index, empty if tile is noTile
+    struct IndexEntry {
+        TileKey key{};
+        uint32_t tile = noTile;
+    };
+    // Where the quad of a tile is & the next tile of its cell, same index as
+    // tiles. m_Index points at the first tile of a cell
+    struct Slot {
+        uint64_t chunk = 0;
+        // noQuad if not drawn (BeginEditing)
+        uint32_t quad;
+        uint32_t next;
+    };
+    // Every tile size in use, queries look up the cells of each
+    struct SizeCount {
+        glm::vec2 size;
+        uint32_t count;
+        // Tiles not at pos = cell * size, they can reach into the
+        // neighbour cells
+        uint32_t offGrid;
+    };
+
+    // File layout, all little endian:
+    // header | chunkCount * chunk entry | tileCount * tile record,
+    // the tiles of a chunk are stored one after another
+    struct FileHeader {
+        std::array<char, 4> magic;
+        uint32_t version;
+        float chunkSize;
+        uint32_t textureCount;
+        uint32_t chunkCount;
+        uint32_t tileCount;
+    };
+    struct FileChunk {
+        glm::ivec2 chunk;
+        glm::vec2 min;
+        glm::vec2 max;
+        uint32_t firstTile;
+        uint32_t tileCount;
+    };
+    struct FileTile {
+        glm::vec2 pos;
+        glm::vec2 size;
+        uint16_t texture;
+        // Bit 0: collidable
+        uint16_t flags;
+    };
+
+    float m_ChunkSize;
+    uint32_t m_DrawnChunks = 0;
+    // First tile of every cell, linear probing in one vector so adding
+    // tiles (streaming) doesn't allocate a node per tile. Power of two
+    // size, at most half full
+    std::vector<IndexEntry> m_Index;
+    uint32_t m_IndexCount = 0;
+    std::vector<Slot> m_Slots;
+    std::vector<SizeCount> m_Sizes;
+    // Stamp of the last QuerySegment that tested the tile, same index as
+    // tiles. Off grid tiles can be found from several cells
+    mutable std::vector<uint32_t> m_Visited;
+    mutable uint32_t m_VisitStamp = 0;
+
+    // Opened level file
+    MappedFile m_File;
+    std::vector<const Texture2D *> m_FileTextures;
+    // Chunks of the file that were streamed in already
+    std::vector<bool> m_Streamed;
+
+    static TileKey m_Key(const glm::vec2 &pos, const glm::vec2 &size);
+    [[nodiscard]] uint64_t m_ChunkKey(const glm::vec2 &pos) const;
+    // Index of the tile, an existing one if the same tile is there already
+    uint32_t m_AddTile(const glm::vec2 &pos, const glm::vec2 &size,
+                       const Texture2D *tex);
+    void m_AddQuad(uint32_t index);
+    void m_RemoveQuad(uint32_t index);
+    void m_RemoveTile(uint32_t index);
+    // The index or next that points at the tile
+    uint32_t &m_LinkTo(uint32_t index);
+    // Entry of the key or the empty entry it would go to, m_Index can't be
+    // empty
+    [[nodiscard]] size_t m_IndexSlot(const TileKey &key) const;
+    void m_ReserveIndex(size_t count);
+    void m_InsertIndex(const TileKey &key, uint32_t tile);
+    void m_EraseIndex(size_t slot);
+    void m_CountSize(const Tile &tile, int change);
+    // First tile of the cell of the grid with this tile size, noTile if empty
+    [[nodiscard]] uint32_t m_FirstAt(const glm::ivec2 &cell,
+                                     const glm::vec2 &size) const;
+    void m_StreamChunk(const FileChunk &entry, std::vector<uint32_t> &counts);
+    static void m_Upload(Chunk &chunk);
+    static void m_DeleteChunk(Chunk &chunk);
+    void m_Clear();
 };
 } // namespace CPL
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../CPL.h"
+#include "../util/GLState.h"
 #include <glm/glm.hpp>
 
 namespace CPL {
@@ -33,16 +34,16 @@ class CubeTex {
     CubeTex &operator=(CubeTex &&other) noexcept {
         if (this != &other) {
             if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-                glDeleteVertexArrays(1, &m_VAO);
+                GLState::DeleteVertexArray(m_VAO);
             }
             if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-                glDeleteBuffers(1, &m_VBO);
+                GLState::DeleteBuffer(m_VBO);
             }
             if (m_VAOAtlas != 0 && glIsVertexArray(m_VAOAtlas)) {
-                glDeleteVertexArrays(1, &m_VAOAtlas);
+                GLState::DeleteVertexArray(m_VAOAtlas);
             }
             if (m_VBOAtlas != 0 && glIsBuffer(m_VBOAtlas)) {
-                glDeleteBuffers(1, &m_VBOAtlas);
+                GLState::DeleteBuffer(m_VBOAtlas);
             }
 
             pos = other.pos;
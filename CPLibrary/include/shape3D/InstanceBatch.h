@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../CPL.h"
+#include "../Shader.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace CPL {
+struct Color;
+
+// Collects cubes & spheres (DrawCube, DrawCubeTex, DrawCubeTexAtlas,
+// DrawSphere) and draws every mesh/texture combination with one instanced
+// draw call. The meshes are unit sized & built once, every shape only adds
+// its offset, size, color & atlas flag to the instance buffer
+class InstanceBatch {
+  public:
+    struct Instance {
+        glm::vec3 offset;
+        glm::vec3 size;
+        uint32_t color;
+        // 1 uses the 3x2 cube atlas texture coordinates
+        float atlas;
+    };
+
+    // Mesh ids for Add
+    static constexpr uint32_t cubeMesh = 0;
+    // Sphere of the given SphereGeometry LOD
+    static uint32_t GetSphereMesh(const size_t lod) {
+        return static_cast<uint32_t>(lod) + 1;
+    }
+
+    InstanceBatch() = default;
+    ~InstanceBatch();
+
+    InstanceBatch(const InstanceBatch &) = delete;
+    InstanceBatch &operator=(const InstanceBatch &) = delete;
+
+    // maxInstances is the amount of shapes after which the batch flushes.
+    // Needs SphereGeometry::Init first
+    void Init(uint32_t maxInstances);
+
+    // shader is a 3D shape shader or the depth shader. size is the full
+    // size of cubes & the radius (in every axis) of spheres
+    void Add(const Shader &shader, uint32_t mesh, uint32_t texture,
+             const glm::vec3 &pos, const glm::vec3 &size, const Color &color,
+             bool atlas);
+
+    // Sorts & draws everything collected so far with the shader of Add
+    void Flush();
+    [[nodiscard]] bool IsEmpty() const { return m_Instances.empty(); }
+    [[nodiscard]] uint32_t GetDrawCalls() const { return m_DrawCalls; }
+    void ResetDrawCalls() { m_DrawCalls = 0; }
+
+  private:
+    struct Mesh {
+        uint32_t VAO = 0;
+        bool indexed = false;
+        // Vertices or indices
+        int first = 0;
+        int count = 0;
+    };
+    struct Entry {
+        uint64_t key;
+        // Index in m_Instances
+        uint32_t first;
+    };
+
+    uint32_t m_CubeVAO{}, m_CubeVBO{}, m_SphereVAO{};
+    uint32_t m_InstanceVBO{};
+    uint32_t m_MaxInstances = 0;
+    uint32_t m_DrawCalls = 0;
+    const Shader *m_Shader = nullptr;
+    // Taken again whenever the shader changes
+    UniformHandle m_InstancedUniform, m_TexUniform;
+    std::vector<Mesh> m_Meshes;
+    std::vector<Entry> m_Entries;
+    std::vector<Instance> m_Instances;
+    // m_Instances in draw order (BatchBuffer::SortItems)
+    std::vector<Instance> m_Sorted;
+
+    // Vertex attributes of the bound buffers (pos, normal, uv & atlas uv at
+    // the given float offsets) plus the instance attributes
+    void m_SetupVAO(int stride, int atlasOffset) const;
+    void m_SetInstanceAttributes(size_t firstInstance) const;
+};
+} // namespace CPL
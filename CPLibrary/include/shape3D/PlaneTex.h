@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../CPL.h"
+#include "../util/GLState.h"
 #include <glm/glm.hpp>
 
 namespace CPL {
@@ -32,10 +33,10 @@ class PlaneTex {
     PlaneTex &operator=(PlaneTex &&other) noexcept {
         if (this != &other) {
             if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-                glDeleteVertexArrays(1, &m_VAO);
+                GLState::DeleteVertexArray(m_VAO);
             }
             if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-                glDeleteBuffers(1, &m_VBO);
+                GLState::DeleteBuffer(m_VBO);
             }
 
             pos = other.pos;
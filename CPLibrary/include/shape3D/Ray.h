@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../CPL.h"
+#include "../util/GLState.h"
 #include <glm/glm.hpp>
 
 namespace CPL {
@@ -30,10 +31,10 @@ class Ray {
     Ray &operator=(Ray &&other) noexcept {
         if (this != &other) {
             if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-                glDeleteVertexArrays(1, &m_VAO);
+                GLState::DeleteVertexArray(m_VAO);
             }
             if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-                glDeleteBuffers(1, &m_VBO);
+                GLState::DeleteBuffer(m_VBO);
             }
 
             startPos = other.startPos;
@@ -1,4 +1,5 @@
 #pragma once
+#include "../util/GLState.h"
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -13,7 +14,8 @@ class ShadowMap {
 
     ShadowMap(ShadowMap &&other) noexcept
         :m_DepthMapFBO(other.m_DepthMapFBO), m_DepthMap(other.m_DepthMap),
-          m_ShadowWidth(other.m_ShadowWidth), m_ShadowHeight(other.m_ShadowHeight) {
+          m_ShadowWidth(other.m_ShadowWidth), m_ShadowHeight(other.m_ShadowHeight),
+          m_LightSpaceMatrix(other.m_LightSpaceMatrix) {
         other.m_DepthMapFBO = 0;
         other.m_DepthMap = 0;
     }
@@ -24,13 +26,14 @@ class ShadowMap {
                 glDeleteFramebuffers(1, &m_DepthMapFBO);
             }
             if (m_DepthMap != 0 && glIsTexture(m_DepthMap)) {
-                glDeleteTextures(1, &m_DepthMap);
+                GLState::DeleteTexture(m_DepthMap);
             }
 
             m_ShadowWidth = other.m_ShadowWidth;
             m_ShadowHeight = other.m_ShadowHeight;
             m_DepthMapFBO = other.m_DepthMapFBO;
             m_DepthMap = other.m_DepthMap;
+            m_LightSpaceMatrix = other.m_LightSpaceMatrix;
 
             other.m_DepthMapFBO = 0;
             other.m_DepthMap = 0;
@@ -38,13 +41,16 @@ class ShadowMap {
         return *this;
     }
 
-    void BeginDepthPass(const glm::mat4 &lightSpaceMatrix) const;
+    void BeginDepthPass(const glm::mat4 &lightSpaceMatrix);
     static void EndDepthPass();
+    // Binds the depth map & switches the 3D light shader to its shadow
+    // variant with the light space matrix of the last depth pass
     void BindForReading(uint32_t textureUnit = 1) const;
 
   private:
     uint32_t m_DepthMapFBO{};
     uint32_t m_DepthMap{};
     uint32_t m_ShadowWidth, m_ShadowHeight;
+    glm::mat4 m_LightSpaceMatrix{1.0f};
 };
 } // namespace CPL
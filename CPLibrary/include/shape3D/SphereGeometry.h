@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../CPL.h"
+#include <array>
+#include <glm/glm.hpp>
+
+namespace CPL {
+// Unit spheres in a few tessellation levels, shared by every Sphere &
+// the instanced DrawSphere. The level is picked by how large the sphere
+// is on screen, so far away spheres use less triangles
+class SphereGeometry {
+  public:
+    // Stacks of every level (sectors are twice as many)
+    static constexpr std::array<int, 7> stackLODs = {8,  12, 16, 24,
+                                                     32, 48, 64};
+
+    static void Init();
+    static void Destroy();
+
+    // Level for a sphere seen from the 3D camera
+    static size_t GetLOD(const glm::vec3 &pos, float radius);
+    // Radius 1 around (0, 0, 0)
+    static void Draw(size_t lod);
+
+    // Vertices are pos, normal, uv (8 floats), indices of every level
+    // point into the shared vertex buffer
+    [[nodiscard]] static uint32_t GetVBO() { return s_VBO; }
+    [[nodiscard]] static uint32_t GetEBO() { return s_EBO; }
+    [[nodiscard]] static int GetFirstIndex(const size_t lod) {
+        return s_Meshes[lod].first;
+    }
+    [[nodiscard]] static int GetIndexCount(const size_t lod) {
+        return s_Meshes[lod].count;
+    }
+
+  private:
+    struct Mesh {
+        int first = 0;
+        int count = 0;
+    };
+
+    static uint32_t s_VAO, s_VBO, s_EBO;
+    static std::array<Mesh, stackLODs.size()> s_Meshes;
+};
+} // namespace CPL
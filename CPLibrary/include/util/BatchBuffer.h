@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace CPL {
+// Shared steps of the batches that refill a GL buffer on every flush
+// (ShapeBatch, SpriteBatch, InstanceBatch & ParticleSystem)
+class BatchBuffer {
+  public:
+    // Writes size bytes of data to the start of the bound GL_ARRAY_BUFFER.
+    // The old storage (capacity bytes) is orphaned first, so the driver
+    // hands out new memory instead of waiting for the previous draw to
+    // finish reading it
+    static void Upload(size_t capacity, const void *data, size_t size);
+
+    // Stable sorts the entries by entry.key, so equal keys keep submission
+    // order, & copies the count items from items[entry.first] of every
+    // entry to sorted. The sort is skipped if the entries are in order
+    // (e.g. particles of one texture & layer)
+    template <typename Entry, typename Item>
+    static void SortItems(std::vector<Entry> &entries,
+                          const std::vector<Item> &items, size_t count,
+                          std::vector<Item> &sorted) {
+        const auto byKey = [](const Entry &a, const Entry &b) {
+            return a.key < b.key;
+        };
+        if (!std::is_sorted(entries.begin(), entries.end(), byKey))
+            std::stable_sort(entries.begin(), entries.end(), byKey);
+
+        sorted.clear();
+        for (const Entry &entry : entries)
+            sorted.insert(sorted.end(), items.begin() + entry.first,
+                          items.begin() + entry.first + count);
+    }
+
+    // draw(entry, first, count) once per run of entries with the same
+    // runKey(entry), first & count in entries
+    template <typename Entry, typename RunKey, typename Draw>
+    static void ForEachRun(const std::vector<Entry> &entries,
+                           RunKey &&runKey, Draw &&draw) {
+        size_t runStart = 0;
+        for (size_t i = 1; i <= entries.size(); i++) {
+            if (i < entries.size() &&
+                runKey(entries[i]) == runKey(entries[runStart]))
+                continue;
+            draw(entries[runStart], runStart, i - runStart);
+            runStart = i;
+        }
+    }
+};
+} // namespace CPL
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+
+namespace CPL {
+// Shadow copy of the GL state the library changes: program, VAO, array &
+// element buffer, texture units, blend/depth/cull state & viewport. Calls
+// that would not change anything are skipped & counted.
+// All of the library goes through here, call Invalidate after changing the
+// same state with plain GL calls
+class GLState {
+  public:
+    struct Stats {
+        // Calls that reached GL
+        uint32_t issued = 0;
+        // Calls skipped because the state was already set
+        uint32_t elided = 0;
+    };
+
+    static constexpr uint32_t maxTextureUnits = 16;
+
+    static void UseProgram(uint32_t program);
+    static void BindVertexArray(uint32_t VAO);
+    static void BindArrayBuffer(uint32_t buffer);
+    // The element buffer belongs to the bound VAO, so it is only cached
+    // until the next VAO change
+    static void BindElementBuffer(uint32_t buffer);
+    // target is GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+    static void BindTexture(uint32_t unit, GLenum target, uint32_t texture);
+
+    static void SetBlend(bool enabled);
+    static void BlendFunc(GLenum src, GLenum dst);
+    static void SetDepthTest(bool enabled);
+    static void SetDepthMask(bool enabled);
+    static void DepthFunc(GLenum func);
+    static void SetCullFace(bool enabled);
+    static void CullFace(GLenum face);
+    static void Viewport(int x, int y, int width, int height);
+
+    // Delete & forget the bindings, GL may give the id to a new object
+    static void DeleteVertexArray(uint32_t VAO);
+    static void DeleteBuffer(uint32_t buffer);
+    static void DeleteTexture(uint32_t texture);
+
+    // Forget everything, the next call of every kind reaches GL
+    static void Invalidate();
+    // Called once per frame by UpdateCPL
+    static void NewFrame();
+    // Counts of the previous frame
+    [[nodiscard]] static Stats GetFrameStats() { return s_LastFrame; }
+
+  private:
+    static constexpr uint32_t unknown = UINT32_MAX;
+
+    struct Cache {
+        uint32_t program = unknown;
+        uint32_t VAO = unknown;
+        uint32_t arrayBuffer = unknown;
+        uint32_t elementBuffer = unknown;
+        uint32_t activeUnit = unknown;
+        // 2D & cube map binding of every unit
+        std::array<std::array<uint32_t, 2>, maxTextureUnits> textures{};
+        // 0 off, 1 on, -1 unknown
+        int8_t blend = -1, depthTest = -1, depthMask = -1, cullFace = -1;
+        GLenum blendSrc = GL_NONE, blendDst = GL_NONE;
+        GLenum depthFunc = GL_NONE, cullFaceMode = GL_NONE;
+        std::array<int, 4> viewport{-1, -1, -1, -1};
+    };
+
+    static Cache s_Cache;
+    static Stats s_Frame, s_LastFrame;
+
+    // True (& counts the call) if cached != value, then stores value
+    template <typename T> static bool m_Changed(T &cached, const T &value) {
+        if (cached == value) {
+            s_Frame.elided++;
+            return false;
+        }
+        cached = value;
+        s_Frame.issued++;
+        return true;
+    }
+    static void m_SetCapability(GLenum capability, int8_t &cached,
+                                bool enabled);
+};
+} // namespace CPL
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CPL {
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile). Pages are
+// only read from disk when they are touched
+class MappedFile {
+  public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &filePath);
+    ~MappedFile() { m_Unmap(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : m_Data(other.m_Data), m_Size(other.m_Size) {
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+    }
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            m_Unmap();
+            m_Data = other.m_Data;
+            m_Size = other.m_Size;
+            other.m_Data = nullptr;
+            other.m_Size = 0;
+        }
+        return *this;
+    }
+
+    [[nodiscard]] bool IsOpen() const { return m_Data != nullptr; }
+    [[nodiscard]] const uint8_t *GetData() const { return m_Data; }
+    [[nodiscard]] size_t GetSize() const { return m_Size; }
+
+  private:
+    const uint8_t *m_Data = nullptr;
+    size_t m_Size = 0;
+
+    void m_Unmap();
+};
+} // namespace CPL
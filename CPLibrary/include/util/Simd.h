@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+
+// Thin wrapper over the vector instructions of the target, so hot loops
+// (e.g. ParticleSystem::Update) are written once. width floats are
+// processed per operation: 8 with AVX2, 4 with SSE2 or NEON (AArch64),
+// 1 otherwise (e.g. Emscripten). Loads & stores don't need alignment
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CPL_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPL_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CPL_SIMD_NEON
+#endif
+
+namespace CPL::Simd {
+#if defined(CPL_SIMD_AVX2)
+using Float = __m256;
+using Int = __m256i;
+constexpr uint32_t width = 8;
+
+inline Float Load(const float *p) { return _mm256_loadu_ps(p); }
+inline void Store(float *p, const Float v) { _mm256_storeu_ps(p, v); }
+inline Int LoadInt(const uint32_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline void StoreInt(uint32_t *p, const Int v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+}
+inline Float Set(const float v) { return _mm256_set1_ps(v); }
+inline Int SetInt(const uint32_t v) {
+    return _mm256_set1_epi32(static_cast<int>(v));
+}
+
+inline Float Add(const Float a, const Float b) { return _mm256_add_ps(a, b); }
+inline Float Sub(const Float a, const Float b) { return _mm256_sub_ps(a, b); }
+inline Float Mul(const Float a, const Float b) { return _mm256_mul_ps(a, b); }
+inline Float Div(const Float a, const Float b) { return _mm256_div_ps(a, b); }
+inline Float Min(const Float a, const Float b) { return _mm256_min_ps(a, b); }
+inline Float Max(const Float a, const Float b) { return _mm256_max_ps(a, b); }
+// All bits set in the lanes where a > b
+inline Float Greater(const Float a, const Float b) {
+    return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+}
+// Bit i is set if lane i of a mask is set
+inline int MoveMask(const Float mask) { return _mm256_movemask_ps(mask); }
+
+inline Int And(const Int a, const Int b) { return _mm256_and_si256(a, b); }
+inline Int Or(const Int a, const Int b) { return _mm256_or_si256(a, b); }
+template <int bits> Int ShiftLeft(const Int v) {
+    return _mm256_slli_epi32(v, bits);
+}
+template <int bits> Int ShiftRight(const Int v) {
+    return _mm256_srli_epi32(v, bits);
+}
+// Only for values below 2^31
+inline Float ToFloat(const Int v) { return _mm256_cvtepi32_ps(v); }
+// Rounds towards zero
+inline Int ToInt(const Float v) { return _mm256_cvttps_epi32(v); }
+#elif defined(CPL_SIMD_SSE2)
+using Float = __m128;
+using Int = __m128i;
+constexpr uint32_t width = 4;
+
+inline Float Load(const float *p) { return _mm_loadu_ps(p); }
+inline void Store(float *p, const Float v) { _mm_storeu_ps(p, v); }
+inline Int LoadInt(const uint32_t *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void StoreInt(uint32_t *p, const Int v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+inline Float Set(const float v) { return _mm_set1_ps(v); }
+inline Int SetInt(const uint32_t v) {
+    return _mm_set1_epi32(static_cast<int>(v));
+}
+
+inline Float Add(const Float a, const Float b) { return _mm_add_ps(a, b); }
+inline Float Sub(const Float a, const Float b) { return _mm_sub_ps(a, b); }
+inline Float Mul(const Float a, const Float b) { return _mm_mul_ps(a, b); }
+inline Float Div(const Float a, const Float b) { return _mm_div_ps(a, b); }
+inline Float Min(const Float a, const Float b) { return _mm_min_ps(a, b); }
+inline Float Max(const Float a, const Float b) { return _mm_max_ps(a, b); }
+inline Float Greater(const Float a, const Float b) { return _mm_cmpgt_ps(a, b); }
+inline int MoveMask(const Float mask) { return _mm_movemask_ps(mask); }
+
+inline Int And(const Int a, const Int b) { return _mm_and_si128(a, b); }
+inline Int Or(const Int a, const Int b) { return _mm_or_si128(a, b); }
+template <int bits> Int ShiftLeft(const Int v) {
+    return _mm_slli_epi32(v, bits);
+}
+template <int bits> Int ShiftRight(const Int v) {
+    return _mm_srli_epi32(v, bits);
+}
+inline Float ToFloat(const Int v) { return _mm_cvtepi32_ps(v); }
+inline Int ToInt(const Float v) { return _mm_cvttps_epi32(v); }
+#elif defined(CPL_SIMD_NEON)
+using Float = float32x4_t;
+using Int = uint32x4_t;
+constexpr uint32_t width = 4;
+
+inline Float Load(const float *p) { return vld1q_f32(p); }
+inline void Store(float *p, const Float v) { vst1q_f32(p, v); }
+inline Int LoadInt(const uint32_t *p) { return vld1q_u32(p); }
+inline void StoreInt(uint32_t *p, const Int v) { vst1q_u32(p, v); }
+inline Float Set(const float v) { return vdupq_n_f32(v); }
+inline Int SetInt(const uint32_t v) { return vdupq_n_u32(v); }
+
+inline Float Add(const Float a, const Float b) { return vaddq_f32(a, b); }
+inline Float Sub(const Float a, const Float b) { return vsubq_f32(a, b); }
+inline Float Mul(const Float a, const Float b) { return vmulq_f32(a, b); }
+inline Float Div(const Float a, const Float b) { return vdivq_f32(a, b); }
+inline Float Min(const Float a, const Float b) { return vminq_f32(a, b); }
+inline Float Max(const Float a, const Float b) { return vmaxq_f32(a, b); }
+inline Float Greater(const Float a, const Float b) {
+    return vreinterpretq_f32_u32(vcgtq_f32(a, b));
+}
+inline int MoveMask(const Float mask) {
+    const uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+    return static_cast<int>(vgetq_lane_u32(bits, 0) |
+                            vgetq_lane_u32(bits, 1) << 1 |
+                            vgetq_lane_u32(bits, 2) << 2 |
+                            vgetq_lane_u32(bits, 3) << 3);
+}
+
+inline Int And(const Int a, const Int b) { return vandq_u32(a, b); }
+inline Int Or(const Int a, const Int b) { return vorrq_u32(a, b); }
+template <int bits> Int ShiftLeft(const Int v) { return vshlq_n_u32(v, bits); }
+template <int bits> Int ShiftRight(const Int v) {
+    // The immediate has to be 1 to 32
+    if constexpr (bits == 0)
+        return v;
+    else
+        return vshrq_n_u32(v, bits);
+}
+inline Float ToFloat(const Int v) { return vcvtq_f32_u32(v); }
+inline Int ToInt(const Float v) { return vcvtq_u32_f32(v); }
+#else
+using Float = float;
+using Int = uint32_t;
+constexpr uint32_t width = 1;
+
+inline Float Load(const float *p) { return *p; }
+inline void Store(float *p, const Float v) { *p = v; }
+inline Int LoadInt(const uint32_t *p) { return *p; }
+inline void StoreInt(uint32_t *p, const Int v) { *p = v; }
+inline Float Set(const float v) { return v; }
+inline Int SetInt(const uint32_t v) { return v; }
+
+inline Float Add(const Float a, const Float b) { return a + b; }
+inline Float Sub(const Float a, const Float b) { return a - b; }
+inline Float Mul(const Float a, const Float b) { return a * b; }
+inline Float Div(const Float a, const Float b) { return a / b; }
+// Second operand if one is NaN, like the SSE instructions
+inline Float Min(const Float a, const Float b) { return a < b ? a : b; }
+inline Float Max(const Float a, const Float b) { return a > b ? a : b; }
+inline Float Greater(const Float a, const Float b) {
+    return a > b ? 1.0f : 0.0f;
+}
+inline int MoveMask(const Float mask) { return mask != 0.0f ? 1 : 0; }
+
+inline Int And(const Int a, const Int b) { return a & b; }
+inline Int Or(const Int a, const Int b) { return a | b; }
+template <int bits> Int ShiftLeft(const Int v) { return v << bits; }
+template <int bits> Int ShiftRight(const Int v) { return v >> bits; }
+inline Float ToFloat(const Int v) { return static_cast<float>(v); }
+inline Int ToInt(const Float v) {
+    return v > 0.0f ? static_cast<uint32_t>(v) : 0;
+}
+#endif
+} // namespace CPL::Simd
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CPL {
+// Fixed set of worker threads that run the tasks of ParallelFor. The
+// calling thread works too, so with 0 workers everything runs on it (e.g.
+// Emscripten builds without pthreads)
+class ThreadPool {
+  public:
+    // 0 uses one worker less than the hardware threads
+    explicit ThreadPool(uint32_t workers = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Calls task(i) for every i in [0, count) & returns when all are done.
+    // Tasks are handed out in order but run in any order & on any thread,
+    // they must not call ParallelFor of the same pool
+    void ParallelFor(uint32_t count,
+                     const std::function<void(uint32_t)> &task);
+
+    // Workers plus the calling thread
+    [[nodiscard]] uint32_t GetThreadCount() const {
+        return static_cast<uint32_t>(m_Workers.size()) + 1;
+    }
+
+    // Created on first use
+    static ThreadPool &GetShared();
+
+  private:
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+
+    // Current ParallelFor
+    const std::function<void(uint32_t)> *m_Task = nullptr;
+    uint32_t m_Count = 0;
+    std::atomic<uint32_t> m_Next{0};
+    // Workers that did not finish the current job yet
+    uint32_t m_Busy = 0;
+    uint64_t m_Job = 0;
+    bool m_Stop = false;
+
+    void m_WorkerLoop();
+    void m_RunTasks();
+};
+} // namespace CPL
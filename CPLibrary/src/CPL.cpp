@@ -1,5 +1,6 @@
 #include "../include/CPL.h"
 #include "../include/Engine.h"
+#include "../include/util/GLState.h"
 #include <GLFW/glfw3.h>
 
 namespace CPL {
@@ -61,15 +62,17 @@ void SetDirLight3D(const DirectionalLight &light) {
     Engine::SetDirLight3D(light);
 }
 void EnableFog(const bool enabled) { Engine::EnableFog(enabled); }
+void EnableShadows(const bool enabled) { Engine::EnableShadows(enabled); }
+void SetShadowFilter(const int radius) { Engine::SetShadowFilter(radius); }
 void SetFog(const float fogStart, const float fogEnd, const Color &color) {
     Engine::SetFog(fogStart, fogEnd, color);
 }
 void EnableTransparency() {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::SetBlend(true);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 void EnableDepth(const bool enabled) {
-    glDepthMask(static_cast<GLboolean>(enabled));
+    GLState::SetDepthMask(enabled);
 }
 void BeginPostProcessing() { Engine::BeginPostProcessing(); }
 void EndPostProcessing() { Engine::EndPostProcessing(); }
@@ -121,12 +124,28 @@ void DrawLine(const glm::vec2 &startPos, const glm::vec2 &endPos,
               const Color &color) {
     Engine::DrawLine(startPos, endPos, color);
 }
-void DrawTex2D(Texture2D *const tex, const glm::vec2 &pos, const Color &color) {
-    Engine::DrawTex2D(tex, pos, color);
+void EnableShapeBatching(const bool enabled) {
+    Engine::EnableShapeBatching(enabled);
+}
+void EnableSpriteBatching(const bool enabled) {
+    Engine::EnableSpriteBatching(enabled);
+}
+void EnableSpriteSorting(const bool enabled) {
+    Engine::EnableSpriteSorting(enabled);
+}
+void EnableInstancing(const bool enabled) {
+    Engine::EnableInstancing(enabled);
+}
+void EnableDrawQueue(const bool enabled) {
+    Engine::EnableDrawQueue(enabled);
+}
+void DrawTex2D(Texture2D *const tex, const glm::vec2 &pos, const Color &color,
+               const int layer) {
+    Engine::DrawTex2D(tex, pos, color, layer);
 }
 void DrawTex2DRot(Texture2D *const tex, const glm::vec2 &pos, const float angle,
-                  const Color &color) {
-    Engine::DrawTex2DRot(tex, pos, angle, color);
+                  const Color &color, const int layer) {
+    Engine::DrawTex2DRot(tex, pos, angle, color, layer);
 }
 void DrawText(const glm::vec2 &pos, const float scale, const std::string &text,
               const Color &color) {
@@ -137,6 +156,12 @@ void DrawTextShadow(const glm::vec2 &pos, const glm::vec2 &shadowOff,
                     const Color &color, const Color &shadowColor) {
     Engine::DrawTextShadow(pos, shadowOff, scale, text, color, shadowColor);
 }
+void DrawTextOutline(const glm::vec2 &pos, const float scale,
+                     const std::string &text, const Color &color,
+                     const Color &outlineColor, const float outlineWidth) {
+    Engine::DrawTextOutline(pos, scale, text, color, outlineColor,
+                            outlineWidth);
+}
 std::string GetDefaultFont() { return "defaultFont"; }
 void DrawCube(const glm::vec3 &pos, const glm::vec3 &size, const Color &color) {
     Engine::DrawCube(pos, size, color);
@@ -233,5 +258,6 @@ Camera3D &GetCam3D() { return Engine::GetCam3D(); }
 GLFWwindow *GetWindow() { return Engine::GetWindow(); }
 
 Shader &GetShader(const DrawModes &mode) { return Engine::GetShader(mode); }
+Shader &GetTextSDFShader() { return Engine::GetTextSDFShader(); }
 DrawModes &GetCurMode() { return Engine::GetCurMode(); }
 } // namespace CPL
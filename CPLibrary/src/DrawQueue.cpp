@@ -0,0 +1,145 @@
+#include "../include/DrawQueue.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace CPL {
+DrawCommand DrawCommand::Shape(const Type type, const Shader &shader,
+                               const glm::vec2 &pos, const glm::vec2 &size,
+                               const float angle, const Color &color,
+                               const bool filled) {
+    DrawCommand command;
+    command.type = type;
+    command.flag = filled;
+    command.shader = &shader;
+    command.pos = glm::vec3(pos, 0.0f);
+    command.size = glm::vec3(size, 0.0f);
+    command.angle = angle;
+    command.color = color;
+    return command;
+}
+
+DrawCommand DrawCommand::Sprite(const Shader &shader, const uint32_t texture,
+                                const int layer, const glm::vec2 &pos,
+                                const glm::vec2 &size, const float angle,
+                                const glm::vec4 &uvRect, const Color &color) {
+    DrawCommand command;
+    command.type = Type::SPRITE;
+    command.layer = layer;
+    command.shader = &shader;
+    command.texture = texture;
+    command.pos = glm::vec3(pos, 0.0f);
+    command.size = glm::vec3(size, 0.0f);
+    command.angle = angle;
+    command.uvRect = uvRect;
+    command.color = color;
+    return command;
+}
+
+DrawCommand DrawCommand::Instance(const Shader &shader, const uint32_t mesh,
+                                  const uint32_t texture, const glm::vec3 &pos,
+                                  const glm::vec3 &size, const Color &color,
+                                  const bool atlas) {
+    DrawCommand command;
+    command.type = Type::INSTANCE;
+    command.flag = atlas;
+    command.shader = &shader;
+    command.texture = texture;
+    command.mesh = mesh;
+    command.pos = pos;
+    command.size = size;
+    command.color = color;
+    return command;
+}
+
+void DrawQueue::SetView(const View &view) {
+    m_Current = view;
+    m_CurrentStored = false;
+}
+
+bool DrawQueue::Record(const DrawCommand &command) {
+    if (!m_CurrentStored) {
+        // Not shared with an earlier BeginDraw even if the camera is the
+        // same, layers must not move draws into another pass
+        if (m_Views.size() >= maxViews)
+            return false;
+        m_Views.push_back(m_Current);
+        m_CurrentStored = true;
+    }
+
+    DrawCommand &stored = m_Commands.emplace_back(command);
+    stored.view = static_cast<uint8_t>(m_Views.size() - 1);
+    m_Entries.push_back(
+        {m_MakeKey(stored), static_cast<uint32_t>(m_Commands.size() - 1)});
+    return true;
+}
+
+uint64_t DrawQueue::m_ShaderID(const Shader *const shader) {
+    const auto it = std::find(m_Shaders.begin(), m_Shaders.end(), shader);
+    if (it != m_Shaders.end())
+        return static_cast<uint64_t>(it - m_Shaders.begin());
+    // Only 6 bits, later shaders share the last id (only affects grouping)
+    if (m_Shaders.size() >= 63)
+        return 63;
+    m_Shaders.push_back(shader);
+    return m_Shaders.size() - 1;
+}
+
+uint64_t DrawQueue::m_MakeKey(const DrawCommand &command) {
+    const uint64_t layer =
+        static_cast<uint8_t>(std::clamp(command.layer, -128, 127) + 128);
+    uint64_t key = static_cast<uint64_t>(command.view) << 60 | layer << 52;
+
+    const View &view = m_Views[command.view];
+    const bool translucent = !view.depthTest ||
+                             command.type != DrawCommand::Type::INSTANCE ||
+                             command.color.a < 255;
+    if (translucent)
+        return key | 1ull << 51 | (m_Sequence++ & ((1ull << 51) - 1));
+
+    // Positive floats sort like their bits, the top 24 bits are enough
+    const float distance = glm::length(command.pos - view.viewPos);
+    uint32_t depthBits = 0;
+    std::memcpy(&depthBits, &distance, sizeof(float));
+
+    const uint64_t state = (command.texture & 0xFFFFu) << 5 |
+                           (command.mesh & 0x1Fu);
+    return key | m_ShaderID(command.shader) << 45 | state << 24 |
+           depthBits >> 8;
+}
+
+const std::vector<DrawQueue::Entry> &DrawQueue::Sort() {
+    // LSD radix sort on bytes, skipping bytes that are the same in every key
+    // (e.g. the layer byte if nothing uses layers)
+    if (m_Entries.empty())
+        return m_Entries;
+    m_Sorted.resize(m_Entries.size());
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        std::array<uint32_t, 256> counts{};
+        for (const Entry &entry : m_Entries)
+            counts[(entry.key >> shift) & 0xFF]++;
+        if (counts[(m_Entries[0].key >> shift) & 0xFF] == m_Entries.size())
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t &count : counts) {
+            const uint32_t n = count;
+            count = offset;
+            offset += n;
+        }
+        for (const Entry &entry : m_Entries)
+            m_Sorted[counts[(entry.key >> shift) & 0xFF]++] = entry;
+        m_Entries.swap(m_Sorted);
+    }
+    return m_Entries;
+}
+
+void DrawQueue::Clear() {
+    m_Commands.clear();
+    m_Entries.clear();
+    m_Views.clear();
+    m_Shaders.clear();
+    m_CurrentStored = false;
+    m_Sequence = 0;
+}
+} // namespace CPL
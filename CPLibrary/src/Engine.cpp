@@ -1,26 +1,37 @@
 #include "../include/Engine.h"
 #include "../include/Audio.h"
+#include "../include/DrawQueue.h"
 #include "../include/Shader.h"
+#include "../include/ShaderCache.h"
+#include "../include/ShaderVariants.h"
 #include "../include/Text.h"
+#include "../include/UniformBlocks.h"
 #include "../include/shape2D/Circle.h"
 #include "../include/shape2D/GlobalLight.h"
 #include "../include/shape2D/Line.h"
 #include "../include/shape2D/PointLight.h"
 #include "../include/shape2D/Rectangle.h"
 #include "../include/shape2D/ScreenQuad.h"
+#include "../include/shape2D/ShapeBatch.h"
+#include "../include/shape2D/ShapeGeometry.h"
+#include "../include/shape2D/SpriteBatch.h"
 #include "../include/shape2D/Texture2D.h"
 #include "../include/shape2D/Triangle.h"
 #include "../include/shape3D/Cube.h"
 #include "../include/shape3D/CubeMap.h"
 #include "../include/shape3D/CubeTex.h"
 #include "../include/shape3D/DirectionalLight.h"
+#include "../include/shape3D/InstanceBatch.h"
 #include "../include/shape3D/PlaneTex.h"
 #include "../include/shape3D/Ray.h"
 #include "../include/shape3D/PointLight3D.h"
 #include "../include/shape3D/Sphere.h"
+#include "../include/shape3D/SphereGeometry.h"
 #include "../include/timer/TimerManager.h"
+#include "../include/util/GLState.h"
 #include "../include/util/Logging.h"
 #include "../include/util/OpenGLDebug.h"
+#include "../include/util/ScopedTimer.h"
 #include "GLFW/glfw3.h"
 #include "stb_image.h"
 #include <memory>
@@ -35,13 +46,32 @@ glm::mat4 Engine::s_Projection3D;
 
 CPL::Shader Engine::s_Shape2DShader;
 CPL::Shader Engine::s_TextShader;
+CPL::Shader Engine::s_TextSDFShader;
 CPL::Shader Engine::s_TextureShader;
 CPL::Shader Engine::s_LightShape2DShader;
 CPL::Shader Engine::s_LightTextureShader;
 CPL::Shader Engine::s_ScreenShader;
-
-CPL::Shader Engine::s_Shape3DShader;
-CPL::Shader Engine::s_LightShape3DShader;
+CPL::Shader Engine::s_ShapeBatchShader;
+CPL::Shader Engine::s_LightShapeBatchShader;
+CPL::Shader Engine::s_SpriteBatchShader;
+CPL::Shader Engine::s_LightSpriteBatchShader;
+CPL::Shader Engine::s_ParticleShader;
+CPL::Shader Engine::s_LightParticleShader;
+
+CPL::Shader Engine::s_Missing3DShader;
+CPL::Shader *Engine::s_Shape3DShader = &s_Missing3DShader;
+CPL::Shader *Engine::s_LightShape3DShader = &s_Missing3DShader;
+CPL::ShaderVariants Engine::s_Shape3DVariants;
+CPL::ShaderVariants Engine::s_LightShape3DVariants;
+std::array<CPL::Shader *, 12> Engine::s_LightShape3DTable{};
+std::array<CPL::Shader *, 2> Engine::s_Shape3DTable{};
+int Engine::s_Selected3D = -1;
+int Engine::s_NumPointLights3D = 0;
+int Engine::s_ShadowFilter = 1;
+bool Engine::s_FogEnabled = false;
+bool Engine::s_ShadowsEnabled = false;
+uint32_t Engine::s_ShadowUnit = 1;
+glm::mat4 Engine::s_LightSpaceMatrix(1.0f);
 CPL::Shader Engine::s_CubeMapShader;
 CPL::Shader Engine::s_DepthShader;
 
@@ -62,6 +92,15 @@ std::queue<uint32_t> Engine::s_CharQueue;
 CPL::Camera2D Engine::s_Camera2D;
 CPL::Camera3D Engine::s_Camera3D;
 CPL::ScreenQuad Engine::s_ScreenQuad;
+CPL::ShapeBatch Engine::s_ShapeBatch;
+bool Engine::s_ShapeBatching = true;
+CPL::SpriteBatch Engine::s_SpriteBatch;
+bool Engine::s_SpriteBatching = true;
+CPL::InstanceBatch Engine::s_InstanceBatch;
+bool Engine::s_Instancing = true;
+CPL::DrawQueue Engine::s_DrawQueue;
+bool Engine::s_QueueDraws = false;
+bool Engine::s_DepthPass = false;
 
 bool Engine::s_CharInputEnabled;
 
@@ -78,6 +117,7 @@ void Engine::UpdateCPL() {
     CalcFPS();
     CPL::TimerManager::Update(GetDeltaTime());
     CPL::AudioManager::Update();
+    CPL::GLState::NewFrame();
 }
 
 void Engine::ShowDetails() {
@@ -228,7 +268,20 @@ void Engine::InitWindow(const int width, const int height, const char *title,
 
     OpenGLDebug::EnableOpenGLDebug();
 
-    InitShaders();
+    CPL::UniformBlocks::Init();
+    {
+        ScopedTimer timer("All shaders loaded (cache: " +
+                          std::string(CPL::ShaderCache::IsSupported()
+                                          ? CPL::ShaderCache::GetDirectory()
+                                          : "unsupported") +
+                          ")");
+        InitShaders();
+    }
+    s_ShapeBatch.Init(65536);
+    s_SpriteBatch.Init(16384);
+    CPL::ShapeGeometry::Init();
+    CPL::SphereGeometry::Init();
+    s_InstanceBatch.Init(16384);
 #ifdef __EMSCRIPTEN__
     CPL::Text::Init("/assets/fonts/default.ttf", "defaultFont",
                     CPL::TextureFiltering::NEAREST);
@@ -279,6 +332,10 @@ void Engine::SetWindowIcon(const std::string &filePath) {
 void Engine::DestroyWindow() { glfwSetWindowShouldClose(s_Window, 1); }
 
 void Engine::CloseWindow() {
+    CPL::UniformBlocks::Destroy();
+    CPL::ShapeGeometry::Destroy();
+    CPL::SphereGeometry::Destroy();
+    CPL::Text::Shutdown();
     glfwTerminate();
     CPL::AudioManager::Close();
 }
@@ -299,6 +356,9 @@ void Engine::InitShaders() {
                                   "/assets/shaders/web/frag/shader_web.frag");
     s_TextShader = CPL::Shader("/assets/shaders/web/vert/text_web.vert",
                                "/assets/shaders/web/frag/text_web.frag");
+    s_TextSDFShader =
+        CPL::Shader("/assets/shaders/web/vert/text_web.vert",
+                    "/assets/shaders/web/frag/textSDF_web.frag");
     s_TextureShader = CPL::Shader("/assets/shaders/web/vert/texture_web.vert",
                                   "/assets/shaders/web/frag/texture_web.frag");
     s_LightShape2DShader =
@@ -309,11 +369,32 @@ void Engine::InitShaders() {
                     "assets/shaders/web/frag/lightTexture_web.frag");
     s_ScreenShader = CPL::Shader("/assets/shaders/web/vert/screen_web.vert",
                                  "/assets/shaders/web/frag/screen_web.frag");
+    s_ShapeBatchShader =
+        CPL::Shader("/assets/shaders/web/vert/batch_web.vert",
+                    "/assets/shaders/web/frag/batch_web.frag");
+    s_LightShapeBatchShader =
+        CPL::Shader("/assets/shaders/web/vert/lightBatch_web.vert",
+                    "/assets/shaders/web/frag/lightBatch_web.frag");
+    s_SpriteBatchShader =
+        CPL::Shader("/assets/shaders/web/vert/spriteBatch_web.vert",
+                    "/assets/shaders/web/frag/spriteBatch_web.frag");
+    s_LightSpriteBatchShader =
+        CPL::Shader("/assets/shaders/web/vert/lightSpriteBatch_web.vert",
+                    "/assets/shaders/web/frag/lightSpriteBatch_web.frag");
+    s_ParticleShader =
+        CPL::Shader("/assets/shaders/web/vert/particle_web.vert",
+                    "/assets/shaders/web/frag/spriteBatch_web.frag");
+    s_LightParticleShader =
+        CPL::Shader("/assets/shaders/web/vert/lightParticle_web.vert",
+                    "/assets/shaders/web/frag/lightSpriteBatch_web.frag");
 #else
     s_Shape2DShader = CPL::Shader("assets/shaders/default/vert/2D/shader.vert",
                                   "assets/shaders/default/frag/2D/shader.frag");
     s_TextShader = CPL::Shader("assets/shaders/default/vert/2D/text.vert",
                                "assets/shaders/default/frag/2D/text.frag");
+    s_TextSDFShader =
+        CPL::Shader("assets/shaders/default/vert/2D/text.vert",
+                    "assets/shaders/default/frag/2D/textSDF.frag");
     s_TextureShader =
         CPL::Shader("assets/shaders/default/vert/2D/texture.vert",
                     "assets/shaders/default/frag/2D/texture.frag");
@@ -325,15 +406,36 @@ void Engine::InitShaders() {
                     "assets/shaders/default/frag/2D/lightTexture.frag");
     s_ScreenShader = CPL::Shader("assets/shaders/default/vert/2D/screen.vert",
                                  "assets/shaders/default/frag/2D/screen.frag");
-
-    s_Shape3DShader = CPL::Shader("assets/shaders/default/vert/3D/shape.vert",
-                                  "assets/shaders/default/frag/3D/shape.frag");
+    s_ShapeBatchShader =
+        CPL::Shader("assets/shaders/default/vert/2D/batch.vert",
+                    "assets/shaders/default/frag/2D/batch.frag");
+    s_LightShapeBatchShader =
+        CPL::Shader("assets/shaders/default/vert/2D/lightBatch.vert",
+                    "assets/shaders/default/frag/2D/lightBatch.frag");
+    s_SpriteBatchShader =
+        CPL::Shader("assets/shaders/default/vert/2D/spriteBatch.vert",
+                    "assets/shaders/default/frag/2D/spriteBatch.frag");
+    s_LightSpriteBatchShader =
+        CPL::Shader("assets/shaders/default/vert/2D/lightSpriteBatch.vert",
+                    "assets/shaders/default/frag/2D/lightSpriteBatch.frag");
+    s_ParticleShader =
+        CPL::Shader("assets/shaders/default/vert/2D/particle.vert",
+                    "assets/shaders/default/frag/2D/spriteBatch.frag");
+    s_LightParticleShader =
+        CPL::Shader("assets/shaders/default/vert/2D/lightParticle.vert",
+                    "assets/shaders/default/frag/2D/lightSpriteBatch.frag");
+
+    s_Shape3DVariants =
+        CPL::ShaderVariants("assets/shaders/default/vert/3D/shape.vert",
+                            "assets/shaders/default/frag/3D/shape.frag");
     s_CubeMapShader =
         CPL::Shader("assets/shaders/default/vert/3D/cubeMapShader.vert",
                     "assets/shaders/default/frag/3D/cubeMapShader.frag");
-    s_LightShape3DShader =
-        CPL::Shader("assets/shaders/default/vert/3D/lightShape.vert",
-                    "assets/shaders/default/frag/3D/lightShape.frag");
+    s_LightShape3DVariants =
+        CPL::ShaderVariants("assets/shaders/default/vert/3D/lightShape.vert",
+                            "assets/shaders/default/frag/3D/lightShape.frag");
+    PrecompileShaders3D();
+    SelectShaders3D();
     s_DepthShader =
         CPL::Shader("assets/shaders/default/vert/3D/depthShader.vert",
                     "assets/shaders/default/frag/3D/depthShader.frag");
@@ -341,6 +443,10 @@ void Engine::InitShaders() {
 }
 
 void Engine::BeginDraw(const CPL::DrawModes &mode, const bool mode2D) {
+    s_ShapeBatch.Flush();
+    s_SpriteBatch.Flush();
+    s_InstanceBatch.Flush();
+
     CPL::Shader *shader = nullptr;
     s_CurrentDrawMode = mode;
 
@@ -350,42 +456,53 @@ void Engine::BeginDraw(const CPL::DrawModes &mode, const bool mode2D) {
         break;
     case CPL::DrawModes::TEXT:
         shader = &s_TextShader;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        CPL::GLState::SetBlend(true);
+        CPL::GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         CPL::Text::Use("defaultFont");
         break;
     case CPL::DrawModes::TEX:
         shader = &s_TextureShader;
         break;
     case CPL::DrawModes::SHAPE_2D_LIGHT:
-        shader = &s_LightShape3DShader;
+        shader = &s_LightShape2DShader;
         break;
     case CPL::DrawModes::TEX_LIGHT:
         shader = &s_LightTextureShader;
         break;
     case CPL::DrawModes::SHAPE_3D:
-        shader = &s_Shape3DShader;
+        shader = s_Shape3DShader;
         break;
     case CPL::DrawModes::SHAPE_3D_LIGHT:
-        shader = &s_LightShape3DShader;
+        shader = s_LightShape3DShader;
         break;
     }
+    if (shader == &s_Missing3DShader) {
+        static bool logged = false;
+        if (!logged)
+            Logging::Log(Logging::MessageStates::ERROR,
+                         "3D draw modes need the 3D shaders, which this "
+                         "build does not have");
+        logged = true;
+    }
     shader->Use();
 
+    // Every shader reads the projection from the shared camera block
+    CPL::DrawQueue::View view;
+    view.viewPos = s_Camera3D.position;
     if (mode == CPL::DrawModes::SHAPE_3D ||
         mode == CPL::DrawModes::SHAPE_3D_LIGHT) {
         float aspect = GetScreenWidth() / GetScreenHeight();
-        shader->SetMatrix4fv("projection",
-                             s_Camera3D.GetProjectionMatrix(aspect) *
-                                 s_Camera3D.GetViewMatrix());
-        glEnable(GL_DEPTH_TEST);
+        view.projection = s_Camera3D.GetProjectionMatrix(aspect) *
+                          s_Camera3D.GetViewMatrix();
+        view.depthTest = true;
     } else {
-        const glm::mat4 view = s_Camera2D.GetViewMatrix();
-        const glm::mat4 viewProjection = s_Projection2D * view;
-        shader->SetMatrix4fv("projection",
-                             mode2D ? viewProjection : s_Projection2D);
-        glDisable(GL_DEPTH_TEST);
+        view.projection = mode2D ? s_Projection2D * s_Camera2D.GetViewMatrix()
+                                 : s_Projection2D;
     }
+    CPL::UniformBlocks::SetCamera(view.projection, view.viewPos);
+    CPL::GLState::SetDepthTest(view.depthTest);
+    // Queued draws are replayed with the camera they were recorded with
+    s_DrawQueue.SetView(view);
 }
 void Engine::ResetShader() {
     CPL::Shader *shader = nullptr;
@@ -396,160 +513,176 @@ void Engine::ResetShader() {
         break;
     case CPL::DrawModes::TEXT:
         shader = &s_TextShader;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        CPL::GLState::SetBlend(true);
+        CPL::GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         CPL::Text::Use("defaultFont");
         break;
     case CPL::DrawModes::TEX:
         shader = &s_TextureShader;
         break;
     case CPL::DrawModes::SHAPE_2D_LIGHT:
-        shader = &s_LightShape3DShader;
+        shader = &s_LightShape2DShader;
         break;
     case CPL::DrawModes::TEX_LIGHT:
         shader = &s_LightTextureShader;
         break;
     case CPL::DrawModes::SHAPE_3D:
-        shader = &s_Shape3DShader;
+        shader = s_Shape3DShader;
         break;
     case CPL::DrawModes::SHAPE_3D_LIGHT:
-        shader = &s_LightShape3DShader;
+        shader = s_LightShape3DShader;
         break;
     }
     shader->Use();
 }
 void Engine::SetAmbientLight2D(const float strength) {
-    s_LightShape2DShader.Use();
-    s_LightShape2DShader.SetFloat("ambient", strength);
-
-    s_LightTextureShader.Use();
-    s_LightTextureShader.SetFloat("ambient", strength);
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::SetAmbientLight2D(strength);
 }
 void Engine::SetGlobalLight2D(const CPL::GlobalLight &light) {
-    s_LightShape2DShader.Use();
-    s_LightShape2DShader.SetFloat("globalLight.intensity", light.intensity);
-    s_LightShape2DShader.SetColor("globalLight.color", light.color);
-
-    s_LightTextureShader.Use();
-    s_LightTextureShader.SetFloat("globalLight.intensity", light.intensity);
-    s_LightTextureShader.SetColor("globalLight.color", light.color);
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::SetGlobalLight2D(light);
 }
 
 void Engine::AddPointLights2D(const std::vector<CPL::PointLight> &lights) {
-    s_LightShape2DShader.Use();
-    s_LightShape2DShader.SetInt("numPointLights",
-                                static_cast<int>(lights.size()));
-    for (int i = 0; i < lights.size(); i++) {
-        s_LightShape2DShader.SetVector2f(
-            "pointLights[" + std::to_string(i) + "].position", lights[i].pos);
-        s_LightShape2DShader.SetFloat(
-            "pointLights[" + std::to_string(i) + "].radius", lights[i].radius);
-        s_LightShape2DShader.SetFloat("pointLights[" + std::to_string(i) +
-                                          "].intensity",
-                                      lights[i].intensity);
-        s_LightShape2DShader.SetColor(
-            "pointLights[" + std::to_string(i) + "].color", lights[i].color);
-    }
-
-    s_LightTextureShader.Use();
-    s_LightTextureShader.SetInt("numPointLights",
-                                static_cast<int>(lights.size()));
-    for (int i = 0; i < lights.size(); i++) {
-        s_LightTextureShader.SetVector2f(
-            "pointLights[" + std::to_string(i) + "].position", lights[i].pos);
-        s_LightTextureShader.SetFloat(
-            "pointLights[" + std::to_string(i) + "].radius", lights[i].radius);
-        s_LightTextureShader.SetFloat("pointLights[" + std::to_string(i) +
-                                          "].intensity",
-                                      lights[i].intensity);
-        s_LightTextureShader.SetColor(
-            "pointLights[" + std::to_string(i) + "].color", lights[i].color);
-    }
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::SetPointLights2D(lights);
 }
 void Engine::SetShininess3D(const float shininess) {
-    s_LightShape3DShader.Use();
-    s_LightShape3DShader.SetFloat("shininess", shininess);
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::SetShininess3D(shininess);
 }
 void Engine::AddPointLights3D(const std::vector<CPL::PointLight3D> &lights) {
-    s_LightShape3DShader.Use();
-    s_LightShape3DShader.SetInt("numPointLights",
-                                static_cast<int>(lights.size()));
-    for (int i = 0; i < lights.size(); i++) {
-        s_LightShape3DShader.SetVector3f(
-            "pointLights[" + std::to_string(i) + "].position", lights[i].pos);
-        s_LightShape3DShader.SetFloat("pointLights[" + std::to_string(i) +
-                                          "].intensity",
-                                      lights[i].intensity);
-        s_LightShape3DShader.SetFloat("pointLights[" + std::to_string(i) +
-                                          "].constant",
-                                      lights[i].constant);
-        s_LightShape3DShader.SetFloat(
-            "pointLights[" + std::to_string(i) + "].linear", lights[i].linear);
-        s_LightShape3DShader.SetFloat("pointLights[" + std::to_string(i) +
-                                          "].quadratic",
-                                      lights[i].quadratic);
-        s_LightShape3DShader.SetColor(
-            "pointLights[" + std::to_string(i) + "].color", lights[i].color);
-    }
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::SetPointLights3D(lights);
+    s_NumPointLights3D = static_cast<int>(
+        std::min(lights.size(),
+                 static_cast<size_t>(CPL::UniformBlocks::maxPointLights)));
+    SelectShaders3D();
 }
 void Engine::SetDirLight3D(const CPL::DirectionalLight &light) {
-    s_LightShape3DShader.Use();
-    s_LightShape3DShader.SetVector3f("viewPos", s_Camera3D.position);
-    s_LightShape3DShader.SetVector3f("dirLight.direction", light.dir);
-    s_LightShape3DShader.SetVector3f("dirLight.ambient",
-                                     glm::vec3(light.ambient.r / 255,
-                                               light.ambient.g / 255,
-                                               light.ambient.b / 255));
-    s_LightShape3DShader.SetVector3f("dirLight.diffuse", light.diffuse);
-    s_LightShape3DShader.SetVector3f("dirLight.specular", light.specular);
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::SetDirLight3D(light);
 }
 
 void Engine::EnableFog(const bool enabled) {
-    s_Shape3DShader.Use();
-    s_Shape3DShader.SetBool("useFog", enabled);
-
-    s_LightShape3DShader.Use();
-    s_LightShape3DShader.SetBool("useFog", enabled);
-
-    ResetShader();
+    FlushBatches();
+    CPL::UniformBlocks::EnableFog(enabled);
+    s_FogEnabled = enabled;
+    SelectShaders3D();
 }
 void Engine::SetFog(const float fogStart, const float fogEnd,
                     const CPL::Color &color) {
-    s_Shape3DShader.Use();
-    s_Shape3DShader.SetFloat("fogStart", fogStart);
-    s_Shape3DShader.SetFloat("fogEnd", fogEnd);
-    s_Shape3DShader.SetColor("fogColor", color);
+    FlushBatches();
+    CPL::UniformBlocks::SetFog(fogStart, fogEnd, color);
+}
+void Engine::SetShadowMap(const uint32_t textureUnit,
+                          const glm::mat4 &lightSpaceMatrix) {
+    FlushBatches();
+    s_ShadowUnit = textureUnit;
+    s_LightSpaceMatrix = lightSpaceMatrix;
+    s_ShadowsEnabled = true;
+    SelectShaders3D();
+}
+void Engine::EnableShadows(const bool enabled) {
+    FlushBatches();
+    s_ShadowsEnabled = enabled;
+    SelectShaders3D();
+}
+void Engine::SetShadowFilter(const int radius) {
+    FlushBatches();
+    s_ShadowFilter = std::clamp(radius, 0, 4);
+    PrecompileShaders3D();
+    SelectShaders3D();
+}
+void Engine::PrecompileShaders3D() {
+    const std::array<int, 3> pointLightTiers = {
+        0, 8, CPL::UniformBlocks::maxPointLights};
+    for (size_t tier = 0; tier < pointLightTiers.size(); tier++) {
+        for (int shadows = 0; shadows < 2; shadows++) {
+            for (int fog = 0; fog < 2; fog++) {
+                std::vector<std::string> defines = {
+                    "MAX_POINT_LIGHTS " +
+                    std::to_string(pointLightTiers[tier])};
+                if (shadows != 0) {
+                    defines.emplace_back("USE_SHADOWS");
+                    defines.emplace_back("PCF_KERNEL " +
+                                         std::to_string(s_ShadowFilter));
+                }
+                if (fog != 0)
+                    defines.emplace_back("USE_FOG");
+                s_LightShape3DTable[(tier * 4) + (shadows * 2) + fog] =
+                    &s_LightShape3DVariants.Get(defines);
+            }
+        }
+    }
+    s_Shape3DTable[0] = &s_Shape3DVariants.Get({});
+    s_Shape3DTable[1] = &s_Shape3DVariants.Get({"USE_FOG"});
+    s_Selected3D = -1;
+}
+void Engine::SelectShaders3D() {
+    // Not compiled (yet), e.g. web builds without 3D shaders
+    if (s_LightShape3DTable[0] == nullptr)
+        return;
+
+    // Smallest point light loop that fits
+    int tier = 0;
+    if (s_NumPointLights3D > 8)
+        tier = 2;
+    else if (s_NumPointLights3D > 0)
+        tier = 1;
+    const int selected = (tier * 4) + (s_ShadowsEnabled ? 2 : 0) +
+                         (s_FogEnabled ? 1 : 0);
+    const bool changed = selected != s_Selected3D;
+    if (changed) {
+        s_Selected3D = selected;
+        s_LightShape3DShader = s_LightShape3DTable[selected];
+        s_Shape3DShader = s_Shape3DTable[s_FogEnabled ? 1 : 0];
+    }
 
-    s_LightShape3DShader.Use();
-    s_LightShape3DShader.SetFloat("fogStart", fogStart);
-    s_LightShape3DShader.SetFloat("fogEnd", fogEnd);
-    s_LightShape3DShader.SetColor("fogColor", color);
+    // Shadow uniforms live in the program, so set them on the variant
+    const bool uniformsSet = s_ShadowsEnabled;
+    if (uniformsSet) {
+        s_LightShape3DShader->Use();
+        s_LightShape3DShader->SetMatrix4fv("lightSpaceMatrix",
+                                           s_LightSpaceMatrix);
+        s_LightShape3DShader->SetInt("shadowMap",
+                                     static_cast<int>(s_ShadowUnit));
+    }
 
-    ResetShader();
+    const bool mode3D = s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D ||
+                        s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT;
+    if (s_DepthPass)
+        s_DepthShader.Use();
+    else if ((changed && mode3D) || uniformsSet)
+        ResetShader();
+}
+void Engine::BeginPostProcessing() {
+    FlushBatches();
+    s_ScreenQuad.BeginUseScreen();
+}
+void Engine::EndPostProcessing() {
+    FlushBatches();
+    CPL::ScreenQuad::EndUseScreen();
 }
-void Engine::BeginPostProcessing() { s_ScreenQuad.BeginUseScreen(); }
-void Engine::EndPostProcessing() { CPL::ScreenQuad::EndUseScreen(); }
 void Engine::ApplyPostProcessing(const CPL::PostProcessingModes &mode) {
+    FlushBatches();
     s_ScreenQuad.Draw(static_cast<int>(mode));
 }
 void Engine::ApplyPostProcessingCustom(const CPL::Shader &shader) {
+    FlushBatches();
     s_ScreenQuad.DrawCustom(shader);
 }
 
 void Engine::DrawTriangle(const glm::vec2 &pos, const glm::vec2 &size,
                           const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::TRIANGLE, GetShapeBatchShader(), pos, size,
+            0.0f, color, true));
+        return;
+    }
+    FlushBatches();
     const auto triangle = CPL::Triangle(pos, size, color);
     triangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                       ? s_LightShape2DShader
@@ -558,6 +691,13 @@ void Engine::DrawTriangle(const glm::vec2 &pos, const glm::vec2 &size,
 }
 void Engine::DrawTriangleRot(const glm::vec2 &pos, const glm::vec2 &size,
                              const float angle, const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::TRIANGLE, GetShapeBatchShader(), pos, size,
+            angle, color, true));
+        return;
+    }
+    FlushBatches();
     const auto triangle = CPL::Triangle(pos, size, color);
     triangle.rotAngle = angle;
     triangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
@@ -567,6 +707,13 @@ void Engine::DrawTriangleRot(const glm::vec2 &pos, const glm::vec2 &size,
 }
 void Engine::DrawTriangleOut(const glm::vec2 &pos, const glm::vec2 &size,
                              const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::TRIANGLE, GetShapeBatchShader(), pos, size,
+            0.0f, color, false));
+        return;
+    }
+    FlushBatches();
     const auto triangle = CPL::Triangle(pos, size, color);
     triangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                       ? s_LightShape2DShader
@@ -575,6 +722,13 @@ void Engine::DrawTriangleOut(const glm::vec2 &pos, const glm::vec2 &size,
 }
 void Engine::DrawTriangleRotOut(const glm::vec2 &pos, const glm::vec2 &size,
                                 const float angle, const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::TRIANGLE, GetShapeBatchShader(), pos, size,
+            angle, color, false));
+        return;
+    }
+    FlushBatches();
     const auto triangle = CPL::Triangle(pos, size, color);
     triangle.rotAngle = angle;
     triangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
@@ -585,6 +739,13 @@ void Engine::DrawTriangleRotOut(const glm::vec2 &pos, const glm::vec2 &size,
 
 void Engine::DrawRect(const glm::vec2 &pos, const glm::vec2 &size,
                       const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::RECT, GetShapeBatchShader(), pos, size,
+            0.0f, color, true));
+        return;
+    }
+    FlushBatches();
     const auto rectangle = CPL::Rectangle(pos, size, color);
     rectangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                        ? s_LightShape2DShader
@@ -593,6 +754,13 @@ void Engine::DrawRect(const glm::vec2 &pos, const glm::vec2 &size,
 }
 void Engine::DrawRectRot(const glm::vec2 &pos, const glm::vec2 &size,
                          const float angle, const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::RECT, GetShapeBatchShader(), pos, size,
+            angle, color, true));
+        return;
+    }
+    FlushBatches();
     const auto rectangle = CPL::Rectangle(pos, size, color);
     rectangle.rotAngle = angle;
     rectangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
@@ -602,6 +770,13 @@ void Engine::DrawRectRot(const glm::vec2 &pos, const glm::vec2 &size,
 }
 void Engine::DrawRectOut(const glm::vec2 &pos, const glm::vec2 &size,
                          const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::RECT, GetShapeBatchShader(), pos, size,
+            0.0f, color, false));
+        return;
+    }
+    FlushBatches();
     const auto rectangle = CPL::Rectangle(pos, size, color);
     rectangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                        ? s_LightShape2DShader
@@ -610,6 +785,13 @@ void Engine::DrawRectOut(const glm::vec2 &pos, const glm::vec2 &size,
 }
 void Engine::DrawRectRotOut(const glm::vec2 &pos, const glm::vec2 &size,
                             const float angle, const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::RECT, GetShapeBatchShader(), pos, size,
+            angle, color, false));
+        return;
+    }
+    FlushBatches();
     const auto rectangle = CPL::Rectangle(pos, size, color);
     rectangle.rotAngle = angle;
     rectangle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
@@ -620,6 +802,13 @@ void Engine::DrawRectRotOut(const glm::vec2 &pos, const glm::vec2 &size,
 
 void Engine::DrawCircle(const glm::vec2 &pos, const float radius,
                         const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::CIRCLE, GetShapeBatchShader(), pos,
+            glm::vec2(radius), 0.0f, color, true));
+        return;
+    }
+    FlushBatches();
     const auto circle = CPL::Circle(pos, radius, color);
     circle.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                     ? s_LightShape2DShader
@@ -627,6 +816,13 @@ void Engine::DrawCircle(const glm::vec2 &pos, const float radius,
 }
 void Engine::DrawCircleOut(const glm::vec2 &pos, const float radius,
                            const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::CIRCLE, GetShapeBatchShader(), pos,
+            glm::vec2(radius), 0.0f, color, false));
+        return;
+    }
+    FlushBatches();
     const auto circle = CPL::Circle(pos, radius, color);
     circle.DrawOutline(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                            ? s_LightShape2DShader
@@ -635,25 +831,183 @@ void Engine::DrawCircleOut(const glm::vec2 &pos, const float radius,
 
 void Engine::DrawLine(const glm::vec2 &startPos, const glm::vec2 &endPos,
                       const CPL::Color &color) {
+    if (s_ShapeBatching) {
+        SubmitDraw(CPL::DrawCommand::Shape(
+            CPL::DrawCommand::Type::LINE, GetShapeBatchShader(), startPos,
+            endPos, 0.0f, color, true));
+        return;
+    }
+    FlushBatches();
     const auto line = CPL::Line(startPos, endPos, color);
     line.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
                   ? s_LightShape2DShader
                   : s_Shape2DShader);
 }
 
+void Engine::EnableShapeBatching(const bool enabled) {
+    FlushBatches();
+    s_ShapeBatching = enabled;
+}
+void Engine::EnableSpriteBatching(const bool enabled) {
+    FlushBatches();
+    s_SpriteBatching = enabled;
+}
+void Engine::EnableSpriteSorting(const bool enabled) {
+    FlushBatches();
+    s_SpriteBatch.SetSortByTexture(enabled);
+}
+void Engine::EnableInstancing(const bool enabled) {
+    FlushBatches();
+    s_Instancing = enabled;
+}
+void Engine::EnableDrawQueue(const bool enabled) {
+    FlushBatches();
+    s_QueueDraws = enabled;
+}
+void Engine::FlushBatches() {
+    SubmitDrawQueue();
+    // Uses the shader that is already bound (3D mode or depth pass)
+    s_InstanceBatch.Flush();
+    if (s_ShapeBatch.IsEmpty() && s_SpriteBatch.IsEmpty())
+        return;
+    // The batches bind their own shaders, so switch back to the one of the
+    // current draw mode afterwards
+    s_ShapeBatch.Flush();
+    s_SpriteBatch.Flush();
+    ResetShader();
+}
+const CPL::Shader &Engine::GetShapeBatchShader() {
+    return s_CurrentDrawMode == CPL::DrawModes::SHAPE_2D_LIGHT
+               ? s_LightShapeBatchShader
+               : s_ShapeBatchShader;
+}
+const CPL::Shader &Engine::GetSpriteBatchShader() {
+    return s_CurrentDrawMode == CPL::DrawModes::TEX_LIGHT
+               ? s_LightSpriteBatchShader
+               : s_SpriteBatchShader;
+}
+const CPL::Shader &Engine::GetParticleShader() {
+    return s_CurrentDrawMode == CPL::DrawModes::TEX_LIGHT
+               ? s_LightParticleShader
+               : s_ParticleShader;
+}
+void Engine::SubmitDraw(const CPL::DrawCommand &command) {
+    // The depth pass draws right away, its shader is only bound during it
+    if (!s_QueueDraws || s_DepthPass) {
+        ExecuteDraw(command);
+        return;
+    }
+    if (!s_DrawQueue.Record(command)) {
+        SubmitDrawQueue();
+        s_DrawQueue.Record(command);
+    }
+}
+void Engine::ExecuteDraw(const CPL::DrawCommand &command) {
+    using Type = CPL::DrawCommand::Type;
+    const glm::vec2 pos(command.pos);
+    const glm::vec2 size(command.size);
+
+    switch (command.type) {
+    case Type::RECT:
+        s_SpriteBatch.Flush();
+        s_ShapeBatch.AddRect(*command.shader, pos, size, command.angle,
+                             command.color, command.flag);
+        break;
+    case Type::TRIANGLE:
+        s_SpriteBatch.Flush();
+        s_ShapeBatch.AddTriangle(*command.shader, pos, size, command.angle,
+                                 command.color, command.flag);
+        break;
+    case Type::CIRCLE:
+        s_SpriteBatch.Flush();
+        s_ShapeBatch.AddCircle(*command.shader, pos, size.x, command.color,
+                               command.flag);
+        break;
+    case Type::LINE:
+        s_SpriteBatch.Flush();
+        s_ShapeBatch.AddLine(*command.shader, pos, size, command.color);
+        break;
+    case Type::SPRITE:
+        s_ShapeBatch.Flush();
+        s_SpriteBatch.Add(*command.shader, command.texture, command.layer, pos,
+                          size, command.angle, command.uvRect, command.color);
+        break;
+    case Type::INSTANCE:
+        s_InstanceBatch.Add(*command.shader, command.mesh, command.texture,
+                            command.pos, command.size, command.color,
+                            command.flag);
+        break;
+    }
+}
+void Engine::SubmitDrawQueue() {
+    if (s_DrawQueue.IsEmpty())
+        return;
+
+    const auto flush = [] {
+        s_InstanceBatch.Flush();
+        s_ShapeBatch.Flush();
+        s_SpriteBatch.Flush();
+    };
+    const auto applyView = [](const CPL::DrawQueue::View &view) {
+        CPL::UniformBlocks::SetCamera(view.projection, view.viewPos);
+        CPL::GLState::SetDepthTest(view.depthTest);
+    };
+
+    // Everything drawn before the queue was recorded comes first
+    flush();
+    int view = -1;
+    for (const auto &entry : s_DrawQueue.Sort()) {
+        const CPL::DrawCommand &command = s_DrawQueue.GetCommand(entry.index);
+        if (command.view != view) {
+            flush();
+            view = command.view;
+            applyView(s_DrawQueue.GetView(command.view));
+        }
+        ExecuteDraw(command);
+    }
+    flush();
+    s_DrawQueue.Clear();
+
+    // Back to the camera & shader of the current BeginDraw
+    applyView(s_DrawQueue.GetCurrentView());
+    ResetShader();
+}
+const CPL::Shader &Engine::GetShader3D() {
+    if (s_DepthPass)
+        return s_DepthShader;
+    return s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
+               ? *s_LightShape3DShader
+               : *s_Shape3DShader;
+}
+
 void Engine::DrawTex2D(CPL::Texture2D *const tex, const glm::vec2 &pos,
-                       const CPL::Color &color) {
+                       const CPL::Color &color, const int layer) {
     tex->pos = pos;
     tex->color = color;
+    if (s_SpriteBatching) {
+        SubmitDraw(CPL::DrawCommand::Sprite(GetSpriteBatchShader(), tex->tex,
+                                            layer, pos, tex->size, tex->rotAngle,
+                                            tex->uvRect, color));
+        return;
+    }
+    FlushBatches();
     tex->Draw(s_CurrentDrawMode == CPL::DrawModes::TEX_LIGHT
                   ? s_LightTextureShader
                   : s_TextureShader);
 }
 void Engine::DrawTex2DRot(CPL::Texture2D *const tex, const glm::vec2 &pos,
-                          const float angle, const CPL::Color &color) {
+                          const float angle, const CPL::Color &color,
+                          const int layer) {
     tex->pos = pos;
     tex->color = color;
     tex->rotAngle = angle;
+    if (s_SpriteBatching) {
+        SubmitDraw(CPL::DrawCommand::Sprite(GetSpriteBatchShader(), tex->tex,
+                                            layer, pos, tex->size, angle,
+                                            tex->uvRect, color));
+        return;
+    }
+    FlushBatches();
     tex->Draw(s_CurrentDrawMode == CPL::DrawModes::TEX_LIGHT
                   ? s_LightTextureShader
                   : s_TextureShader);
@@ -661,104 +1015,193 @@ void Engine::DrawTex2DRot(CPL::Texture2D *const tex, const glm::vec2 &pos,
 
 void Engine::DrawText(const glm::vec2 &pos, const float scale,
                       const std::string &text, const CPL::Color &color) {
-    CPL::Text::DrawText(s_TextShader, text, pos, scale, color);
+    DrawTextStyled(pos, scale, text, color, {});
 }
 void Engine::DrawTextShadow(const glm::vec2 &pos, const glm::vec2 &shadowOff,
                             const float scale, const std::string &text,
                             const CPL::Color &color,
                             const CPL::Color &shadowColor) {
+    // SDF fonts draw the shadow in the same pass
+    if (CPL::Text::IsSDF(CPL::Text::GetCurFont())) {
+        CPL::TextStyle style;
+        style.shadowColor = shadowColor;
+        style.shadowOffset = {shadowOff.x, -shadowOff.y};
+        DrawTextStyled(pos, scale, text, color, style);
+        return;
+    }
+    FlushBatches();
     CPL::Text::DrawText(s_TextShader, text,
                         {pos.x + shadowOff.x, pos.y - shadowOff.y}, scale,
                         shadowColor);
     CPL::Text::DrawText(s_TextShader, text, pos, scale, color);
 }
+void Engine::DrawTextOutline(const glm::vec2 &pos, const float scale,
+                             const std::string &text, const CPL::Color &color,
+                             const CPL::Color &outlineColor,
+                             const float outlineWidth) {
+    if (!CPL::Text::IsSDF(CPL::Text::GetCurFont())) {
+        Logging::Log(Logging::MessageStates::WARNING,
+                     "Outlines need a SDF font");
+    }
+    CPL::TextStyle style;
+    style.outlineColor = outlineColor;
+    style.outlineWidth = outlineWidth;
+    DrawTextStyled(pos, scale, text, color, style);
+}
+void Engine::DrawTextStyled(const glm::vec2 &pos, const float scale,
+                            const std::string &text, const CPL::Color &color,
+                            const CPL::TextStyle &style) {
+    FlushBatches();
+    if (!CPL::Text::IsSDF(CPL::Text::GetCurFont())) {
+        CPL::Text::DrawText(s_TextShader, text, pos, scale, color);
+        return;
+    }
+    s_TextSDFShader.Use();
+    CPL::Text::DrawText(s_TextSDFShader, text, pos, scale, color, style);
+    s_TextShader.Use();
+}
 
 void Engine::DrawCube(const glm::vec3 &pos, const glm::vec3 &size,
                       const CPL::Color &color) {
+    if (s_Instancing) {
+        SubmitDraw(CPL::DrawCommand::Instance(
+            GetShader3D(), CPL::InstanceBatch::cubeMesh, s_WhiteTex->tex, pos,
+            size, color, false));
+        return;
+    }
+    FlushBatches();
     const auto cube = CPL::Cube(pos, size, color);
-    cube.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                  ? s_LightShape3DShader
-                  : s_Shape3DShader);
+    if (s_DepthPass)
+        cube.DrawDepth(s_DepthShader);
+    else
+        cube.Draw(GetShader3D());
 }
 
 void Engine::DrawSphere(const glm::vec3 &pos, const float radius,
                         const CPL::Color &color) {
+    if (s_Instancing) {
+        SubmitDraw(CPL::DrawCommand::Instance(
+            GetShader3D(),
+            CPL::InstanceBatch::GetSphereMesh(
+                CPL::SphereGeometry::GetLOD(pos, radius)),
+            s_WhiteTex->tex, pos, glm::vec3(radius), color, false));
+        return;
+    }
+    FlushBatches();
     const auto sphere = CPL::Sphere(pos, radius, color);
-    sphere.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                    ? s_LightShape3DShader
-                    : s_Shape3DShader);
+    if (s_DepthPass)
+        sphere.DrawDepth(s_DepthShader);
+    else
+        sphere.Draw(GetShader3D());
 }
 
 void Engine::DrawCubeTex(const CPL::Texture2D *const tex, const glm::vec3 &pos,
                          const glm::vec3 &size, const CPL::Color &color) {
+    if (s_Instancing) {
+        SubmitDraw(CPL::DrawCommand::Instance(
+            GetShader3D(), CPL::InstanceBatch::cubeMesh, tex->tex, pos, size,
+            color, false));
+        return;
+    }
+    FlushBatches();
     const auto cubeTex = CPL::CubeTex(pos, size, color);
-    cubeTex.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                     ? s_LightShape3DShader
-                     : s_Shape3DShader,
-                 tex);
+    if (s_DepthPass)
+        cubeTex.DrawDepth(s_DepthShader, tex);
+    else
+        cubeTex.Draw(GetShader3D(), tex);
 }
 
 void Engine::DrawCubeTexAtlas(const CPL::Texture2D *const tex,
                               const glm::vec3 &pos, const glm::vec3 &size,
                               const CPL::Color &color) {
+    if (s_Instancing) {
+        SubmitDraw(CPL::DrawCommand::Instance(
+            GetShader3D(), CPL::InstanceBatch::cubeMesh, tex->tex, pos, size,
+            color, true));
+        return;
+    }
+    FlushBatches();
     const auto cubeTex = CPL::CubeTex(pos, size, color);
-    cubeTex.DrawAtlas(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                          ? s_LightShape3DShader
-                          : s_Shape3DShader,
-                      tex);
+    if (s_DepthPass)
+        cubeTex.DrawDepthAtlas(s_DepthShader, tex);
+    else
+        cubeTex.DrawAtlas(GetShader3D(), tex);
 }
 
 void Engine::DrawPlaneTex(const CPL::Texture2D *const tex, const glm::vec3 &pos,
                           const glm::vec2 &size, const CPL::Color &color) {
+    FlushBatches();
     const auto planeTex = CPL::PlaneTex(pos, glm::vec3(0), size, color);
     planeTex.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                      ? s_LightShape3DShader
-                      : s_Shape3DShader,
+                      ? *s_LightShape3DShader
+                      : *s_Shape3DShader,
                   tex);
 }
 
 void Engine::DrawPlaneTexRot(const CPL::Texture2D *const tex,
                              const glm::vec3 &pos, const glm::vec3 &rot,
                              const glm::vec2 &size, const CPL::Color &color) {
+    FlushBatches();
     const auto planeTex = CPL::PlaneTex(pos, rot, size, color);
     planeTex.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                      ? s_LightShape3DShader
-                      : s_Shape3DShader,
+                      ? *s_LightShape3DShader
+                      : *s_Shape3DShader,
                   tex);
 }
 
 void Engine::DrawRay(const glm::vec3 &startPos, const glm::vec3 &endPos,
                       const CPL::Color &color) {
+    FlushBatches();
     const auto ray = CPL::Ray(startPos, endPos, color);
     ray.Draw(s_CurrentDrawMode == CPL::DrawModes::SHAPE_3D_LIGHT
-                  ? s_LightShape3DShader
-                  : s_Shape3DShader);
+                  ? *s_LightShape3DShader
+                  : *s_Shape3DShader);
 }
 
 void Engine::DrawCubeMap(const CPL::CubeMap *const map) {
-    glDepthMask(GL_FALSE);
+    FlushBatches();
+    CPL::GLState::SetDepthMask(false);
     map->Draw(s_CubeMapShader);
-    glDepthMask(GL_TRUE);
+    CPL::GLState::SetDepthMask(true);
 }
 
 void Engine::DrawCubeMapRot(CPL::CubeMap *map, const glm::vec3 &rot) {
-    glDepthMask(GL_FALSE);
+    FlushBatches();
+    CPL::GLState::SetDepthMask(false);
     map->rot = rot;
     map->Draw(s_CubeMapShader);
     map->rot = glm::vec3(0);
-    glDepthMask(GL_TRUE);
+    CPL::GLState::SetDepthMask(true);
+}
+void Engine::BeginDepthPass(const glm::mat4 &lightSpaceMatrix) {
+    FlushBatches();
+    s_DepthPass = true;
+    s_DepthShader.Use();
+    s_DepthShader.SetMatrix4fv("lightSpaceMatrix", lightSpaceMatrix);
+}
+void Engine::EndDepthPass() {
+    s_InstanceBatch.Flush();
+    s_DepthPass = false;
+    ResetShader();
 }
 
 void Engine::ClearBackground(const CPL::Color &color) {
+    FlushBatches();
     glClearColor(color.r / 255, color.g / 255, color.b / 255, color.a / 255);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void Engine::EndDraw() { glUseProgram(0); }
+void Engine::EndDraw() {
+    SubmitDrawQueue();
+    s_ShapeBatch.Flush();
+    s_SpriteBatch.Flush();
+    s_InstanceBatch.Flush();
+    CPL::GLState::UseProgram(0);
+}
 
 void Engine::FramebufferSizeCallback(GLFWwindow *window, const int width,
                                      const int height) {
-    glViewport(0, 0, width, height);
+    CPL::GLState::Viewport(0, 0, width, height);
 }
 
 void Engine::MouseCallback(GLFWwindow *window, const double xPosIn,
@@ -832,11 +1275,11 @@ void Engine::EnableVSync(const bool enabled) {
 }
 void Engine::EnableFaceCulling(const bool enabled) {
     if (enabled) {
-        glEnable(GL_CULL_FACE);
+        CPL::GLState::SetCullFace(true);
         glFrontFace(GL_CCW);
-        glCullFace(GL_BACK);
+        CPL::GLState::CullFace(GL_BACK);
     } else {
-        glDisable(GL_CULL_FACE);
+        CPL::GLState::SetCullFace(false);
     }
 }
 bool Engine::WindowShouldClose() {
@@ -948,16 +1391,17 @@ CPL::Shader &Engine::GetShader(const CPL::DrawModes &mode) {
         return s_LightTextureShader;
         break;
     case CPL::DrawModes::SHAPE_3D:
-        return s_Shape3DShader;
+        return *s_Shape3DShader;
         break;
     case CPL::DrawModes::SHAPE_3D_LIGHT:
-        return s_LightShape3DShader;
+        return *s_LightShape3DShader;
         break;
     }
     return s_Shape2DShader;
 }
 CPL::DrawModes &Engine::GetCurMode() { return s_CurrentDrawMode; }
 
+CPL::Shader &Engine::GetTextSDFShader() { return s_TextSDFShader; }
 CPL::Shader &Engine::GetScreenQuadShader() { return s_ScreenShader; }
 CPL::Shader &Engine::GetCubeMapShader() { return s_CubeMapShader; }
 CPL::Shader &Engine::GetDepthShader() { return s_DepthShader; }
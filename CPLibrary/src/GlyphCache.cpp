@@ -0,0 +1,183 @@
+#include "../include/GlyphCache.h"
+#include "../include/util/GLState.h"
+#include "../include/util/Logging.h"
+#include <algorithm>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+
+namespace CPL {
+GlyphCache::GlyphCache(FT_FaceRec_ *face, const int pixelSize,
+                       const TextureFiltering &textureFiltering,
+                       const FontRendering &rendering)
+    : m_Face(face) {
+    FT_Set_Pixel_Sizes(m_Face, 0, pixelSize);
+
+    if (rendering == FontRendering::SDF) {
+        // "sdf" renders outlines, "bsdf" bitmap only glyphs
+        FT_Int spread = sdfSpread;
+        if (static_cast<bool>(FT_Property_Set(m_Face->glyph->library, "sdf",
+                                              "spread", &spread)) ||
+            static_cast<bool>(FT_Property_Set(m_Face->glyph->library, "bsdf",
+                                              "spread", &spread))) {
+            Logging::Log(Logging::MessageStates::WARNING,
+                         "FreeType has no SDF renderer, using bitmap font");
+        } else {
+            m_Spread = sdfSpread;
+        }
+    }
+    // Distances are interpolated between texels, nearest would be blocky
+    const bool linear =
+        m_Spread > 0 || textureFiltering == TextureFiltering::LINEAR;
+
+    // Cells fit the bounding box of the font (capped for fonts with a few
+    // huge glyphs) plus a 1 pixel gap against filtering bleed
+    const FT_Size_Metrics &metrics = m_Face->size->metrics;
+    const auto bboxWidth = static_cast<int>(
+        FT_MulFix(m_Face->bbox.xMax - m_Face->bbox.xMin, metrics.x_scale) >> 6);
+    const auto bboxHeight = static_cast<int>(
+        FT_MulFix(m_Face->bbox.yMax - m_Face->bbox.yMin, metrics.y_scale) >> 6);
+    m_CellSize = {std::clamp(bboxWidth, pixelSize / 2, pixelSize * 2) +
+                      (m_Spread * 2) + 2,
+                  std::clamp(bboxHeight, pixelSize / 2, pixelSize * 2) +
+                      (m_Spread * 2) + 2};
+    m_Columns = atlasSize / m_CellSize.x;
+    m_Slots.resize(static_cast<size_t>(m_Columns) *
+                   (atlasSize / m_CellSize.y));
+    m_Pages.resize((s_MaxCodepoint / s_PageSize) + 1);
+    m_CellPixels.resize(static_cast<size_t>(m_CellSize.x) * m_CellSize.y);
+
+    const std::vector<uint8_t> empty(static_cast<size_t>(atlasSize) *
+                                     atlasSize);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &m_Texture);
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_Texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasSize, atlasSize, 0, GL_RED,
+                 GL_UNSIGNED_BYTE, empty.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    linear ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                    linear ? GL_LINEAR : GL_NEAREST);
+
+    // Printable ASCII is used by nearly every string
+    for (uint32_t c = 32; c < 127; c++)
+        Get(c);
+    // SDF quads start spread pixels above the outline
+    if (const Character *h = Get('H'))
+        m_CapHeight = h->bearing.y - m_Spread;
+}
+
+GlyphCache::~GlyphCache() {
+    if (m_Texture != 0)
+        GLState::DeleteTexture(m_Texture);
+    FT_Done_Face(m_Face);
+}
+
+int32_t &GlyphCache::m_Entry(const uint32_t codepoint) {
+    auto &page = m_Pages[codepoint / s_PageSize];
+    if (!page) {
+        page = std::make_unique<Page>();
+        page->fill(-1);
+    }
+    return (*page)[codepoint % s_PageSize];
+}
+
+const Character *GlyphCache::Get(uint32_t codepoint) {
+    if (codepoint > s_MaxCodepoint)
+        codepoint = 0xFFFD;
+
+    int32_t &entry = m_Entry(codepoint);
+    if (entry >= 0) {
+        Slot &slot = m_Slots[entry];
+        slot.lastUse = m_Tick;
+        return &slot.character;
+    }
+
+    const int32_t slotIndex = m_AllocateSlot();
+    if (slotIndex < 0)
+        return nullptr;
+    Slot &slot = m_Slots[slotIndex];
+    if (!m_Rasterize(codepoint, slot, slotIndex)) {
+        // Keep the slot free for the next glyph
+        slot.lastUse = 0;
+        return nullptr;
+    }
+    slot.codepoint = codepoint;
+    slot.lastUse = m_Tick;
+    entry = slotIndex;
+    return &slot.character;
+}
+
+int32_t GlyphCache::m_AllocateSlot() {
+    if (m_UsedSlots < m_Slots.size())
+        return static_cast<int32_t>(m_UsedSlots++);
+
+    // Replace the least recently used glyph that is not part of the
+    // string currently being built
+    const auto lru = std::min_element(
+        m_Slots.begin(), m_Slots.end(),
+        [](const Slot &a, const Slot &b) { return a.lastUse < b.lastUse; });
+    if (lru->lastUse == m_Tick) {
+        Logging::Log(Logging::MessageStates::WARNING,
+                     "Glyph atlas too small for this string");
+        return -1;
+    }
+    if (lru->lastUse != 0) {
+        m_Entry(lru->codepoint) = -1;
+        m_Generation++;
+    }
+    return static_cast<int32_t>(lru - m_Slots.begin());
+}
+
+bool GlyphCache::m_Rasterize(const uint32_t codepoint, Slot &slot,
+                             const int32_t slotIndex) {
+    const bool sdf = m_Spread > 0;
+    if (static_cast<bool>(FT_Load_Char(m_Face, codepoint,
+                                       sdf ? FT_LOAD_DEFAULT : FT_LOAD_RENDER))) {
+        Logging::Log(Logging::MessageStates::ERROR, "Failed to load Glyph");
+        return false;
+    }
+    const FT_GlyphSlot glyph = m_Face->glyph;
+    // Outlines without contours (f.e. space) have nothing to render
+    const bool empty = glyph->format == FT_GLYPH_FORMAT_OUTLINE &&
+                       glyph->outline.n_contours == 0;
+    if (sdf && !empty &&
+        static_cast<bool>(FT_Render_Glyph(glyph, FT_RENDER_MODE_SDF))) {
+        Logging::Log(Logging::MessageStates::ERROR, "Failed to render SDF Glyph");
+        return false;
+    }
+    const FT_Bitmap &bitmap = glyph->bitmap;
+
+    // Glyphs larger than a cell are cut off
+    const glm::ivec2 size = {
+        std::min(static_cast<int>(bitmap.width), m_CellSize.x - 2),
+        std::min(static_cast<int>(bitmap.rows), m_CellSize.y - 2)};
+    std::fill(m_CellPixels.begin(), m_CellPixels.end(), 0);
+    for (int y = 0; y < size.y; y++) {
+        std::copy_n(bitmap.buffer + (static_cast<ptrdiff_t>(y) * bitmap.pitch),
+                    size.x,
+                    m_CellPixels.begin() + ((y + 1) * m_CellSize.x) + 1);
+    }
+
+    const glm::ivec2 cell = {(slotIndex % m_Columns) * m_CellSize.x,
+                             (slotIndex / m_Columns) * m_CellSize.y};
+    // Upload the whole cell so nothing of the replaced glyph is left
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_Texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cell.x, cell.y, m_CellSize.x,
+                    m_CellSize.y, GL_RED, GL_UNSIGNED_BYTE,
+                    m_CellPixels.data());
+
+    constexpr auto atlas = static_cast<float>(atlasSize);
+    const glm::vec2 origin = glm::vec2(cell + 1);
+    slot.character = Character(
+        {origin.x / atlas, origin.y / atlas,
+         (origin.x + static_cast<float>(size.x)) / atlas,
+         (origin.y + static_cast<float>(size.y)) / atlas},
+        size, {glyph->bitmap_left, glyph->bitmap_top},
+        static_cast<uint32_t>(glyph->advance.x));
+    return true;
+}
+} // namespace CPL
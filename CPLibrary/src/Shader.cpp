@@ -1,14 +1,23 @@
 #include "../include/Shader.h"
 #include "../include/CPL.h"
+#include "../include/ShaderCache.h"
+#include "../include/UniformBlocks.h"
+#include "../include/util/GLState.h"
 #include "../include/util/Logging.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 namespace CPL {
-Shader::Shader(const char *vertexPath, const char *fragmentPath) {
-    
+Shader::Shader(const char *vertexPath, const char *fragmentPath,
+               const std::vector<std::string> &defines) {
+    const auto start = std::chrono::steady_clock::now();
+
     std::string vertexCode;
     std::string fragmentCode;
     std::ifstream vShaderFile;
@@ -25,69 +34,214 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath) {
         fShaderStream << fShaderFile.rdbuf();
         vShaderFile.close();
         fShaderFile.close();
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        vertexCode = m_AddDefines(vShaderStream.str(), defines);
+        fragmentCode = m_AddDefines(fShaderStream.str(), defines);
     } catch (std::ifstream::failure &e) {
         Logging::Log(Logging::MessageStates::ERROR,
                      "File not successfully read: " + std::string(e.what()));
         return;
     }
-    const char *vShaderCode = vertexCode.c_str();
-    const char *fShaderCode = fragmentCode.c_str();
-
-    uint32_t vertex = 0;
-    uint32_t fragment = 0;
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, nullptr);
-    glCompileShader(vertex);
-    m_CheckCompileErrors(vertex, "VERTEX");
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, nullptr);
-    glCompileShader(fragment);
-    m_CheckCompileErrors(fragment, "FRAGMENT");
-    m_ID = glCreateProgram();
-    glAttachShader(m_ID, vertex);
-    glAttachShader(m_ID, fragment);
-    glLinkProgram(m_ID);
-    m_CheckCompileErrors(m_ID, "PROGRAM");
-
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-}
-
-void Shader::Use() const { glUseProgram(m_ID); }
+    m_ID = ShaderCache::Load(vertexCode, fragmentCode);
+    const bool cached = m_ID != 0;
+    if (!cached) {
+        const char *vShaderCode = vertexCode.c_str();
+        const char *fShaderCode = fragmentCode.c_str();
+
+        uint32_t vertex = 0;
+        uint32_t fragment = 0;
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, nullptr);
+        glCompileShader(vertex);
+        m_CheckCompileErrors(vertex, "VERTEX");
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, nullptr);
+        glCompileShader(fragment);
+        m_CheckCompileErrors(fragment, "FRAGMENT");
+        m_ID = glCreateProgram();
+        glAttachShader(m_ID, vertex);
+        glAttachShader(m_ID, fragment);
+        ShaderCache::PrepareProgram(m_ID);
+        glLinkProgram(m_ID);
+        if (m_CheckCompileErrors(m_ID, "PROGRAM"))
+            ShaderCache::Store(m_ID, vertexCode, fragmentCode);
+
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+    }
+
+    m_ReflectUniforms();
+    m_BindUniformBlocks();
+
+    const std::chrono::duration<float, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    std::stringstream message;
+    message << std::string(fragmentPath) << (cached ? " loaded from cache in "
+                                                    : " compiled in ")
+            << time.count() << " ms";
+    Logging::Log(Logging::MessageStates::INFO, message.str());
+}
+
+std::string Shader::m_AddDefines(const std::string &code,
+                                const std::vector<std::string> &defines) {
+    if (defines.empty())
+        return code;
+    // #version has to stay the first line
+    const size_t lineEnd = code.find('\n');
+    if (lineEnd == std::string::npos)
+        return code;
+
+    std::string result = code.substr(0, lineEnd + 1);
+    for (const std::string &define : defines)
+        result += "#define " + define + "\n";
+    // Keep the line numbers of compile errors matching the file
+    result += "#line 2\n";
+    result += code.substr(lineEnd + 1);
+    return result;
+}
+
+void Shader::m_BindUniformBlocks() const {
+    int count = 0;
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    for (int i = 0; i < count; i++) {
+        std::array<char, 64> name{};
+        glGetActiveUniformBlockName(m_ID, static_cast<GLuint>(i),
+                                    static_cast<GLsizei>(name.size()), nullptr,
+                                    name.data());
+        const int binding = UniformBlocks::GetBinding(name.data());
+        if (binding < 0) {
+            Logging::Log(Logging::MessageStates::WARNING,
+                         "Shader uniform block \"" + std::string(name.data()) +
+                             "\" is not one of the shared blocks");
+            continue;
+        }
+        glUniformBlockBinding(m_ID, static_cast<GLuint>(i),
+                              static_cast<GLuint>(binding));
+    }
+}
+
+void Shader::m_ReflectUniforms() {
+    m_Uniforms.clear();
+    int count = 0;
+    int maxLength = 0;
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(static_cast<size_t>(std::max(maxLength, 1)));
+
+    for (int i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_ID, static_cast<GLuint>(i), maxLength, &length,
+                           &size, &type, buffer.data());
+        std::string name(buffer.data(), static_cast<size_t>(length));
+        const int32_t location = glGetUniformLocation(m_ID, name.c_str());
+        // Members of uniform blocks have no location
+        if (location < 0)
+            continue;
+
+        // Arrays are reported once as "name[0]", so add the other elements
+        // & the plain name that GL accepts too
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            const std::string base = name.substr(0, name.size() - 3);
+            m_Uniforms.emplace(base, location);
+            for (int e = 1; e < size; e++) {
+                const std::string element =
+                    base + "[" + std::to_string(e) + "]";
+                m_Uniforms.emplace(element,
+                                   glGetUniformLocation(m_ID, element.c_str()));
+            }
+        }
+        m_Uniforms.emplace(std::move(name), location);
+    }
+}
+
+UniformHandle Shader::GetUniform(const std::string &name) const {
+    const auto it = m_Uniforms.find(name);
+    return {it == m_Uniforms.end() ? -1 : it->second};
+}
+
+void Shader::Use() const { GLState::UseProgram(m_ID); }
 
 void Shader::SetBool(const std::string &name, const bool value) const {
-    glUniform1i(glGetUniformLocation(m_ID, name.c_str()),
-                static_cast<int>(value));
+    glUniform1i(GetUniform(name).location, static_cast<int>(value));
 }
 
 void Shader::SetInt(const std::string &name, const int value) const {
-    glUniform1i(glGetUniformLocation(m_ID, name.c_str()), value);
+    glUniform1i(GetUniform(name).location, value);
 }
 
 void Shader::SetFloat(const std::string &name, const float value) const {
-    glUniform1f(glGetUniformLocation(m_ID, name.c_str()), value);
+    glUniform1f(GetUniform(name).location, value);
 }
 
 void Shader::SetColor(const std::string &name, const Color &color) const {
-    glUniform4f(glGetUniformLocation(m_ID, name.c_str()), color.r, color.g,
-                color.b, color.a);
+    glUniform4f(GetUniform(name).location, color.r, color.g, color.b,
+                color.a);
+}
+
+void Shader::SetMatrix3fv(const std::string &name,
+                          const glm::mat3 &matrix) const {
+    glUniformMatrix3fv(GetUniform(name).location, 1, GL_FALSE,
+                       glm::value_ptr(matrix));
 }
 
 void Shader::SetMatrix4fv(const std::string &name,
                           const glm::mat4 &matrix) const {
-    glUniformMatrix4fv(glGetUniformLocation(m_ID, name.c_str()), 1, GL_FALSE,
+    glUniformMatrix4fv(GetUniform(name).location, 1, GL_FALSE,
                        glm::value_ptr(matrix));
 }
 
 void Shader::SetVector2f(const std::string &name, const glm::vec2 &vec2) const {
-    glUniform2f(glGetUniformLocation(m_ID, name.c_str()), vec2.x, vec2.y);
+    glUniform2f(GetUniform(name).location, vec2.x, vec2.y);
 }
 
 void Shader::SetVector3f(const std::string &name, const glm::vec3 &vec3) const {
-    glUniform3f(glGetUniformLocation(m_ID, name.c_str()), vec3.x, vec3.y,
-                vec3.z);
+    glUniform3f(GetUniform(name).location, vec3.x, vec3.y, vec3.z);
+}
+
+void Shader::SetVector4f(const std::string &name, const glm::vec4 &vec4) const {
+    glUniform4f(GetUniform(name).location, vec4.x, vec4.y, vec4.z, vec4.w);
+}
+
+void Shader::SetBool(const UniformHandle handle, const bool value) const {
+    glUniform1i(handle.location, static_cast<int>(value));
+}
+
+void Shader::SetInt(const UniformHandle handle, const int value) const {
+    glUniform1i(handle.location, value);
+}
+
+void Shader::SetFloat(const UniformHandle handle, const float value) const {
+    glUniform1f(handle.location, value);
+}
+
+void Shader::SetColor(const UniformHandle handle, const Color &color) const {
+    glUniform4f(handle.location, color.r, color.g, color.b, color.a);
+}
+
+void Shader::SetMatrix3fv(const UniformHandle handle,
+                          const glm::mat3 &matrix) const {
+    glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Shader::SetMatrix4fv(const UniformHandle handle,
+                          const glm::mat4 &matrix) const {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Shader::SetVector2f(const UniformHandle handle,
+                         const glm::vec2 &vec2) const {
+    glUniform2f(handle.location, vec2.x, vec2.y);
+}
+
+void Shader::SetVector3f(const UniformHandle handle,
+                         const glm::vec3 &vec3) const {
+    glUniform3f(handle.location, vec3.x, vec3.y, vec3.z);
+}
+
+void Shader::SetVector4f(const UniformHandle handle,
+                         const glm::vec4 &vec4) const {
+    glUniform4f(handle.location, vec4.x, vec4.y, vec4.z, vec4.w);
 }
 
 bool Shader::m_CheckCompileErrors(const uint32_t shader,
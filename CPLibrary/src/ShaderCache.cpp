@@ -0,0 +1,157 @@
+#include "../include/ShaderCache.h"
+#include "../include/util/Logging.h"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace CPL {
+namespace {
+// Bump if the file layout changes
+constexpr uint32_t fileVersion = 1;
+constexpr std::array<char, 4> fileMagic = {'C', 'P', 'L', 'P'};
+// FNV-1a offset basis
+constexpr uint64_t hashSeed = 14695981039346656037ull;
+
+struct FileHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    // Hash of the driver string, checked again against hash collisions
+    uint64_t driverHash;
+    uint32_t format;
+    uint32_t length;
+};
+} // namespace
+
+std::string ShaderCache::s_Directory = "shadercache";
+// -1 unknown, checked once a context exists
+int8_t ShaderCache::s_Supported = -1;
+
+void ShaderCache::SetDirectory(const std::string &path) { s_Directory = path; }
+
+bool ShaderCache::IsSupported() {
+#ifdef __EMSCRIPTEN__
+    return false;
+#else
+    if (s_Supported < 0) {
+        int formats = 0;
+        if (glad_glGetProgramBinary != nullptr &&
+            glad_glProgramBinary != nullptr &&
+            glad_glProgramParameteri != nullptr)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        s_Supported = formats > 0 ? 1 : 0;
+    }
+    return s_Supported == 1 && !s_Directory.empty();
+#endif
+}
+
+uint64_t ShaderCache::m_Hash(const std::string &text, uint64_t hash) {
+    // FNV-1a
+    for (const char c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+const std::string &ShaderCache::m_DriverID() {
+    static std::string driver;
+    if (driver.empty()) {
+        for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const auto *text =
+                reinterpret_cast<const char *>(glGetString(name));
+            driver += text != nullptr ? text : "";
+            driver += '|';
+        }
+    }
+    return driver;
+}
+
+std::string ShaderCache::m_FilePath(const std::string &vertexCode,
+                                    const std::string &fragmentCode) {
+    uint64_t hash = m_Hash(m_DriverID(), hashSeed);
+    hash = m_Hash(vertexCode, hash);
+    // Separator so moving code between the stages changes the hash
+    hash = m_Hash(std::string(1, '\0'), hash);
+    hash = m_Hash(fragmentCode, hash);
+
+    std::stringstream name;
+    name << std::hex << hash << ".bin";
+    return (std::filesystem::path(s_Directory) / name.str()).string();
+}
+
+uint32_t ShaderCache::Load(const std::string &vertexCode,
+                           const std::string &fragmentCode) {
+    if (!IsSupported())
+        return 0;
+
+    std::ifstream file(m_FilePath(vertexCode, fragmentCode),
+                       std::ios::binary);
+    if (!file)
+        return 0;
+
+    FileHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(FileHeader));
+    if (!file || header.magic != fileMagic || header.version != fileVersion ||
+        header.driverHash != m_Hash(m_DriverID(), hashSeed))
+        return 0;
+
+    std::vector<char> binary(header.length);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file)
+        return 0;
+
+    const uint32_t program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (success == 0) {
+        // Driver changed its format without changing the version string
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ShaderCache::PrepareProgram(const uint32_t program) {
+    if (IsSupported())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                            GL_TRUE);
+}
+
+void ShaderCache::Store(const uint32_t program, const std::string &vertexCode,
+                        const std::string &fragmentCode) {
+    if (!IsSupported())
+        return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    FileHeader header{fileMagic, fileVersion,
+                      m_Hash(m_DriverID(), hashSeed), 0,
+                      static_cast<uint32_t>(length)};
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+    header.format = format;
+
+    std::error_code error;
+    std::filesystem::create_directories(s_Directory, error);
+    std::ofstream file(m_FilePath(vertexCode, fragmentCode),
+                       std::ios::binary | std::ios::trunc);
+    if (!file) {
+        Logging::Log(Logging::MessageStates::WARNING,
+                     "Could not write shader cache to " + s_Directory);
+        return;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader));
+    file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+}
+} // namespace CPL
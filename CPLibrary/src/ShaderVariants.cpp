@@ -0,0 +1,28 @@
+#include "../include/ShaderVariants.h"
+#include "../include/util/Logging.h"
+
+#include <utility>
+
+namespace CPL {
+ShaderVariants::ShaderVariants(std::string vertexPath,
+                               std::string fragmentPath)
+    : m_VertexPath(std::move(vertexPath)),
+      m_FragmentPath(std::move(fragmentPath)) {}
+
+Shader &ShaderVariants::Get(const std::vector<std::string> &defines) {
+    std::string key;
+    for (const std::string &define : defines)
+        key += define + ';';
+
+    const auto it = m_Variants.find(key);
+    if (it != m_Variants.end())
+        return it->second;
+
+    Logging::Log(Logging::MessageStates::INFO,
+                 "Compiling variant of " + m_FragmentPath + " (" + key + ")");
+    return m_Variants
+        .emplace(key, Shader(m_VertexPath.c_str(), m_FragmentPath.c_str(),
+                             defines))
+        .first->second;
+}
+} // namespace CPL
@@ -1,22 +1,30 @@
 #include "../include/Text.h"
 
 #include "../include/CPL.h"
+#include "../include/GlyphCache.h"
 #include "../include/Shader.h"
+#include "../include/TextMesh.h"
 #include "../include/util/Logging.h"
+#include <algorithm>
 #include <filesystem>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 namespace CPL {
+FT_LibraryRec_ *Text::s_FreeType = nullptr;
 std::string Text::s_CurFont;
-std::map<std::string, std::map<GLchar, Character>> Text::s_Fonts;
-uint32_t Text::s_VAO;
-uint32_t Text::s_VBO;
+std::map<std::string, std::unique_ptr<GlyphCache>> Text::s_Fonts;
+Text::CacheList Text::s_Cache;
+std::unordered_map<std::string,
+                   std::unordered_map<std::string, Text::CacheList::iterator>>
+    Text::s_CacheLookup;
+size_t Text::s_CacheCapacity = 256;
 
 void Text::Init(const std::string &fontPath, const std::string &fontName,
-                const TextureFiltering &textureFiltering) {
-    FT_Library ft{};
-    if (static_cast<bool>(FT_Init_FreeType(&ft))) {
+                const TextureFiltering &textureFiltering,
+                const FontRendering &rendering) {
+    if (s_FreeType == nullptr &&
+        static_cast<bool>(FT_Init_FreeType(&s_FreeType))) {
         Logging::Log(Logging::MessageStates::ERROR,
                      "Could not init FreeType Library");
         exit(-1);
@@ -29,65 +37,22 @@ void Text::Init(const std::string &fontPath, const std::string &fontName,
         exit(-1);
     }
 
+    // The face stays open so glyphs can be rasterized when first used
     FT_Face face{};
-    if (static_cast<bool>(FT_New_Face(ft, fontPath.c_str(), 0, &face))) {
+    if (static_cast<bool>(
+            FT_New_Face(s_FreeType, fontPath.c_str(), 0, &face))) {
         Logging::Log(Logging::MessageStates::ERROR, "Failed to load font");
         exit(-1);
     }
-    FT_Set_Pixel_Sizes(face, 0, 48);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    std::map<GLchar, Character> characters;
-    for (unsigned char c = 0; c < 128; c++) {
-        if (static_cast<bool>(FT_Load_Char(face, c, FT_LOAD_RENDER))) {
-            Logging::Log(Logging::MessageStates::ERROR, "Failed to load Glyph");
-            continue;
-        }
-
-        u_int32_t texture = 0;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8,
-                     static_cast<GLsizei>(face->glyph->bitmap.width),
-                     static_cast<GLsizei>(face->glyph->bitmap.rows), 0, GL_RED,
-                     GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                        textureFiltering == TextureFiltering::LINEAR
-                            ? GL_LINEAR
-                            : GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                        textureFiltering == TextureFiltering::LINEAR
-                            ? GL_LINEAR
-                            : GL_NEAREST);
-
-        Character character(
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<uint32_t>(face->glyph->advance.x));
-        characters.insert(std::pair<char, Character>(c, character));
-    }
-    s_Fonts.insert(std::pair(fontName, characters));
+    if (s_Fonts.find(fontName) != s_Fonts.end()) {
+        // Cached meshes still point to the old atlas
+        ClearCache();
+    }
+    s_Fonts.insert_or_assign(
+        fontName, std::make_unique<GlyphCache>(face, 48, textureFiltering,
+                                               rendering));
     s_CurFont = fontName;
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-
-    glGenVertexArrays(1, &s_VAO);
-    glGenBuffers(1, &s_VBO);
-    glBindVertexArray(s_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, s_VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr,
-                 GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
 }
 
 void Text::Use(const std::string &fontName) {
@@ -98,43 +63,177 @@ void Text::Use(const std::string &fontName) {
 }
 
 void Text::DrawText(const Shader &shader, const std::string &text,
-                    glm::vec2 pos, const float scale, const Color &color) {
-    shader.SetVector3f("textColor", {color.r, color.g, color.b});
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(s_VAO);
-
-    for (char c : text) {
-        const auto [textureID, size, bearing, advance] =
-            s_Fonts[s_CurFont].at(c);
-
-        const float xPos = pos.x + (static_cast<float>(bearing.x) * scale);
-        const float yPos =
-            pos.y + (static_cast<float>((
-                         s_Fonts.at(s_CurFont).at('H').bearing.y - bearing.y)) *
-                     scale);
-        const float width = static_cast<float>(size.x) * scale;
-        const float height = static_cast<float>(size.y) * scale;
-
-        const std::array<std::array<float, 4>, 6> vertices = {
-            {{xPos, yPos + height, 0.0f, 1.0f},
-             {xPos, yPos, 0.0f, 0.0f},
-             {xPos + width, yPos, 1.0f, 0.0f},
-
-             {xPos, yPos + height, 0.0f, 1.0f},
-             {xPos + width, yPos, 1.0f, 0.0f},
-             {xPos + width, yPos + height, 1.0f, 1.0f}}};
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glBindBuffer(GL_ARRAY_BUFFER, s_VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices.data());
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        pos.x += static_cast<float>(advance >> 6) * scale;
-    }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+                    const glm::vec2 pos, const float scale,
+                    const Color &color, const TextStyle &style) {
+    if (text.empty())
+        return;
+    m_GetCachedMesh(s_CurFont, text).Draw(shader, pos, scale, color, style);
+}
+
+bool Text::IsSDF(const std::string &fontName) {
+    return GetSpread(fontName) > 0;
+}
+
+uint32_t Text::BuildVertices(const std::string &fontName,
+                             const std::string &text,
+                             std::vector<float> &vertices, glm::vec2 &size) {
+    vertices.clear();
+    size = glm::vec2(0.0f);
+    const auto fontIt = s_Fonts.find(fontName);
+    if (fontIt == s_Fonts.end())
+        return 0;
+    GlyphCache &font = *fontIt->second;
+    font.BeginUse();
+    // SDF quads are larger than the outline, measure without the padding
+    const auto spread = static_cast<float>(font.GetSpread());
+
+    vertices.reserve(text.size() * 24);
+    float x = 0.0f;
+    float maxAboveBaseline = 0.0f;
+    float maxBelowBaseline = 0.0f;
+    for (size_t i = 0; i < text.size();) {
+        const Character *ch = font.Get(DecodeUTF8(text, i));
+        if (ch == nullptr)
+            continue;
+        const auto &[uv, glyphSize, bearing, advance] = *ch;
+
+        const auto xPos = x + static_cast<float>(bearing.x);
+        const auto yPos = static_cast<float>(font.GetCapHeight() - bearing.y);
+        const auto width = static_cast<float>(glyphSize.x);
+        const auto height = static_cast<float>(glyphSize.y);
+
+        vertices.insert(vertices.end(),
+                        {xPos,         yPos + height, uv.x, uv.w,
+                         xPos,         yPos,          uv.x, uv.y,
+                         xPos + width, yPos,          uv.z, uv.y,
+
+                         xPos,         yPos + height, uv.x, uv.w,
+                         xPos + width, yPos,          uv.z, uv.y,
+                         xPos + width, yPos + height, uv.z, uv.w});
+
+        maxAboveBaseline =
+            std::max(maxAboveBaseline, static_cast<float>(bearing.y) - spread);
+        maxBelowBaseline = std::max(
+            maxBelowBaseline, height - static_cast<float>(bearing.y) - spread);
+        x += static_cast<float>(advance >> 6);
+    }
+    size = {x, maxAboveBaseline + maxBelowBaseline};
+    return font.GetTexture();
+}
+
+uint32_t Text::GetGeneration(const std::string &fontName) {
+    const auto it = s_Fonts.find(fontName);
+    return it == s_Fonts.end() ? 0 : it->second->GetGeneration();
+}
+
+int Text::GetSpread(const std::string &fontName) {
+    const auto it = s_Fonts.find(fontName);
+    return it == s_Fonts.end() ? 0 : it->second->GetSpread();
+}
+
+void Text::SetCacheCapacity(const size_t capacity) {
+    s_CacheCapacity = std::max<size_t>(1, capacity);
+    while (s_Cache.size() > s_CacheCapacity) {
+        const TextMesh &last = s_Cache.back();
+        s_CacheLookup[last.GetFont()].erase(last.GetText());
+        s_Cache.pop_back();
+    }
+}
+
+void Text::ClearCache() {
+    s_CacheLookup.clear();
+    s_Cache.clear();
+}
+
+void Text::Shutdown() {
+    ClearCache();
+    s_Fonts.clear();
+    if (s_FreeType != nullptr) {
+        FT_Done_FreeType(s_FreeType);
+        s_FreeType = nullptr;
+    }
+}
+
+uint32_t Text::DecodeUTF8(const std::string &text, size_t &i) {
+    const auto byte = [&text](const size_t index) {
+        return static_cast<uint8_t>(text[index]);
+    };
+    const uint8_t lead = byte(i);
+    int length = 0;
+    uint32_t codepoint = 0;
+    if (lead < 0x80) {
+        i++;
+        return lead;
+    }
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        codepoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        codepoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        codepoint = lead & 0x07;
+    } else {
+        i++;
+        return 0xFFFD;
+    }
+    if (i + length > text.size()) {
+        i = text.size();
+        return 0xFFFD;
+    }
+    for (int k = 1; k < length; k++) {
+        if ((byte(i + k) & 0xC0) != 0x80) {
+            i += k;
+            return 0xFFFD;
+        }
+        codepoint = (codepoint << 6) | (byte(i + k) & 0x3F);
+    }
+    i += length;
+    return codepoint;
+}
+
+std::string Text::EncodeUTF8(const uint32_t codepoint) {
+    std::string out;
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint <= 0x10FFFF) {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    return out;
+}
+
+TextMesh &Text::m_GetCachedMesh(const std::string &fontName,
+                                const std::string &text) {
+    auto &lookup = s_CacheLookup[fontName];
+    if (const auto it = lookup.find(text); it != lookup.end()) {
+        // Move to the front, the back is replaced first
+        s_Cache.splice(s_Cache.begin(), s_Cache, it->second);
+        return *it->second;
+    }
+
+    if (s_Cache.size() >= s_CacheCapacity) {
+        // Reuse the buffer of the least recently drawn string
+        const auto last = std::prev(s_Cache.end());
+        // Can be the map of another font, lookup stays valid
+        s_CacheLookup[last->GetFont()].erase(last->GetText());
+        last->SetText(fontName, text);
+        s_Cache.splice(s_Cache.begin(), s_Cache, last);
+    } else {
+        s_Cache.emplace_front(fontName, text);
+    }
+    lookup.emplace(text, s_Cache.begin());
+    return s_Cache.front();
 }
 
 glm::vec2 Text::GetTextSize(const std::string &fontName,
@@ -149,14 +248,20 @@ glm::vec2 Text::GetTextSize(const std::string &fontName,
     float maxAboveBaseline = 0.0f;
     float maxBelowBaseline = 0.0f;
 
-    for (char c : text) {
-        const Character &ch = s_Fonts[fontName].at(c);
-        const float h = static_cast<float>(ch.size.y) * scale;
-        maxAboveBaseline = std::max(maxAboveBaseline,
-                                    static_cast<float>(ch.bearing.y) * scale);
+    GlyphCache &font = *s_Fonts.at(fontName);
+    font.BeginUse();
+    const float spread = static_cast<float>(font.GetSpread()) * scale;
+    for (size_t i = 0; i < text.size();) {
+        const Character *ch = font.Get(DecodeUTF8(text, i));
+        if (ch == nullptr)
+            continue;
+        const float h = static_cast<float>(ch->size.y) * scale;
+        maxAboveBaseline = std::max(
+            maxAboveBaseline, (static_cast<float>(ch->bearing.y) * scale) - spread);
         maxBelowBaseline = std::max(
-            maxBelowBaseline, (h - (static_cast<float>(ch.bearing.y) * scale)));
-        width += static_cast<float>(ch.advance >> 6) * scale;
+            maxBelowBaseline,
+            (h - (static_cast<float>(ch->bearing.y) * scale)) - spread);
+        width += static_cast<float>(ch->advance >> 6) * scale;
     }
     height = maxAboveBaseline + maxBelowBaseline;
     return {width, height};
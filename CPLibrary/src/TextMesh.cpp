@@ -0,0 +1,83 @@
+#include "../include/TextMesh.h"
+#include "../include/Shader.h"
+#include "../include/GlyphCache.h"
+#include "../include/Text.h"
+#include "../include/util/GLState.h"
+#include <algorithm>
+
+namespace CPL {
+TextMesh::TextMesh(const std::string &fontName, const std::string &text) {
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+
+    SetText(fontName, text);
+}
+
+TextMesh::~TextMesh() { m_Unload(); }
+
+void TextMesh::m_Unload() const {
+    if (m_VAO != 0 && glIsVertexArray(m_VAO))
+        GLState::DeleteVertexArray(m_VAO);
+    if (m_VBO != 0 && glIsBuffer(m_VBO))
+        GLState::DeleteBuffer(m_VBO);
+}
+
+void TextMesh::SetText(const std::string &fontName, const std::string &text) {
+    m_Font = fontName;
+    m_Text = text;
+
+    static std::vector<float> vertices;
+    m_Texture = Text::BuildVertices(fontName, text, vertices, m_Size);
+    m_Generation = Text::GetGeneration(fontName);
+    m_Spread = Text::GetSpread(fontName);
+    m_VertexCount = static_cast<int>(vertices.size() / 4);
+    if (vertices.empty())
+        return;
+
+    const size_t bytes = vertices.size() * sizeof(float);
+    GLState::BindArrayBuffer(m_VBO);
+    if (bytes > m_BufferSize) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes),
+                     vertices.data(), GL_STATIC_DRAW);
+        m_BufferSize = bytes;
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes),
+                        vertices.data());
+    }
+}
+
+void TextMesh::Draw(const Shader &shader, const glm::vec2 &pos,
+                    const float scale, const Color &color,
+                    const TextStyle &style) {
+    if (m_Generation != Text::GetGeneration(m_Font))
+        SetText(m_Font, m_Text);
+    if (m_VertexCount == 0)
+        return;
+
+    shader.SetVector3f("textColor", {color.r, color.g, color.b});
+    shader.SetVector2f("offset", pos);
+    shader.SetFloat("scale", scale);
+    if (m_Spread > 0) {
+        // The distance goes from 0.5 at the outline to 0 spread pixels away
+        const auto spread = static_cast<float>(m_Spread);
+        shader.SetFloat("outlineWidth",
+                        std::clamp(style.outlineWidth, 0.0f, spread) * 0.5f /
+                            spread);
+        shader.SetColor("outlineColor", style.outlineColor);
+        // Further than the spread the shadow would leave the glyph quad
+        const glm::vec2 offset =
+            glm::clamp(style.shadowOffset / std::max(scale, 0.0001f), -spread,
+                       spread);
+        shader.SetVector2f("shadowOffset",
+                           offset / static_cast<float>(GlyphCache::atlasSize));
+        shader.SetColor("shadowColor", style.shadowColor);
+    }
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_Texture);
+    GLState::BindVertexArray(m_VAO);
+    glDrawArrays(GL_TRIANGLES, 0, m_VertexCount);
+}
+} // namespace CPL
@@ -0,0 +1,161 @@
+#include "../include/UniformBlocks.h"
+#include "../include/shape2D/GlobalLight.h"
+#include "../include/shape2D/PointLight.h"
+#include "../include/shape3D/DirectionalLight.h"
+#include "../include/shape3D/PointLight3D.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace CPL {
+// Offsets have to match the std140 layout of the blocks in the shaders
+static_assert(sizeof(UniformBlocks::Camera) == 80);
+static_assert(sizeof(UniformBlocks::PointLight2DData) == 32);
+static_assert(offsetof(UniformBlocks::Lights2D, ambient) == 32);
+static_assert(offsetof(UniformBlocks::Lights2D, pointLights) == 48);
+static_assert(sizeof(UniformBlocks::PointLight3DData) == 48);
+static_assert(offsetof(UniformBlocks::Lights3D, shininess) == 64);
+static_assert(offsetof(UniformBlocks::Lights3D, pointLights) == 80);
+static_assert(sizeof(UniformBlocks::Fog) == 32);
+
+std::array<uint32_t, UniformBlocks::blockNames.size()> UniformBlocks::s_UBOs{};
+UniformBlocks::Camera UniformBlocks::s_Camera;
+UniformBlocks::Lights2D UniformBlocks::s_Lights2D;
+UniformBlocks::Lights3D UniformBlocks::s_Lights3D;
+UniformBlocks::Fog UniformBlocks::s_Fog;
+
+void UniformBlocks::Init() {
+    if (s_UBOs[0] != 0)
+        return;
+
+    const std::array<std::pair<const void *, size_t>, blockNames.size()>
+        blocks = {{{&s_Camera, sizeof(Camera)},
+                   {&s_Lights2D, sizeof(Lights2D)},
+                   {&s_Lights3D, sizeof(Lights3D)},
+                   {&s_Fog, sizeof(Fog)}}};
+
+    glGenBuffers(static_cast<GLsizei>(s_UBOs.size()), s_UBOs.data());
+    for (size_t i = 0; i < s_UBOs.size(); i++) {
+        glBindBuffer(GL_UNIFORM_BUFFER, s_UBOs[i]);
+        glBufferData(GL_UNIFORM_BUFFER,
+                     static_cast<GLsizeiptr>(blocks[i].second),
+                     blocks[i].first, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(i), s_UBOs[i]);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBlocks::Destroy() {
+    if (s_UBOs[0] == 0)
+        return;
+    glDeleteBuffers(static_cast<GLsizei>(s_UBOs.size()), s_UBOs.data());
+    s_UBOs.fill(0);
+}
+
+int UniformBlocks::GetBinding(const std::string &blockName) {
+    for (size_t i = 0; i < blockNames.size(); i++) {
+        if (blockName == blockNames[i])
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void UniformBlocks::m_Upload(const Binding binding, const void *const data,
+                             const size_t offset, const size_t size) {
+    glBindBuffer(GL_UNIFORM_BUFFER, s_UBOs[static_cast<size_t>(binding)]);
+    glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset),
+                    static_cast<GLsizeiptr>(size),
+                    static_cast<const char *>(data) + offset);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBlocks::SetCamera(const glm::mat4 &projection,
+                              const glm::vec3 &viewPos) {
+    s_Camera.projection = projection;
+    s_Camera.viewPos = viewPos;
+    m_Upload(Binding::CAMERA, &s_Camera, 0, sizeof(Camera));
+}
+
+void UniformBlocks::SetAmbientLight2D(const float strength) {
+    s_Lights2D.ambient = strength;
+    m_Upload(Binding::LIGHTS_2D, &s_Lights2D, offsetof(Lights2D, ambient),
+             sizeof(float));
+}
+
+void UniformBlocks::SetGlobalLight2D(const GlobalLight &light) {
+    s_Lights2D.globalIntensity = light.intensity;
+    s_Lights2D.globalColor = {light.color.r, light.color.g, light.color.b,
+                              light.color.a};
+    m_Upload(Binding::LIGHTS_2D, &s_Lights2D, 0,
+             offsetof(Lights2D, ambient));
+}
+
+void UniformBlocks::SetPointLights2D(const std::vector<PointLight> &lights) {
+    const size_t count =
+        std::min(lights.size(), static_cast<size_t>(maxPointLights));
+    for (size_t i = 0; i < count; i++) {
+        const PointLight &light = lights[i];
+        s_Lights2D.pointLights[i] = {
+            light.pos, light.radius, light.intensity,
+            {light.color.r, light.color.g, light.color.b, light.color.a}};
+    }
+    s_Lights2D.numPointLights = static_cast<int32_t>(count);
+
+    // Count & used lights in one go
+    const size_t first = offsetof(Lights2D, numPointLights);
+    m_Upload(Binding::LIGHTS_2D, &s_Lights2D, first,
+             offsetof(Lights2D, pointLights) - first +
+                 count * sizeof(PointLight2DData));
+}
+
+void UniformBlocks::SetShininess3D(const float shininess) {
+    s_Lights3D.shininess = shininess;
+    m_Upload(Binding::LIGHTS_3D, &s_Lights3D, offsetof(Lights3D, shininess),
+             sizeof(float));
+}
+
+void UniformBlocks::SetDirLight3D(const DirectionalLight &light) {
+    s_Lights3D.dirDirection = glm::vec4(light.dir, 0.0f);
+    s_Lights3D.dirAmbient =
+        glm::vec4(light.ambient.r / 255, light.ambient.g / 255,
+                  light.ambient.b / 255, 0.0f);
+    s_Lights3D.dirDiffuse = glm::vec4(light.diffuse, 0.0f);
+    s_Lights3D.dirSpecular = glm::vec4(light.specular, 0.0f);
+    m_Upload(Binding::LIGHTS_3D, &s_Lights3D, 0,
+             offsetof(Lights3D, shininess));
+}
+
+void UniformBlocks::SetPointLights3D(const std::vector<PointLight3D> &lights) {
+    const size_t count =
+        std::min(lights.size(), static_cast<size_t>(maxPointLights));
+    for (size_t i = 0; i < count; i++) {
+        const PointLight3D &light = lights[i];
+        s_Lights3D.pointLights[i] = {
+            light.pos,
+            0.0f,
+            {light.color.r, light.color.g, light.color.b, light.color.a},
+            light.intensity,
+            light.constant,
+            light.linear,
+            light.quadratic};
+    }
+    s_Lights3D.numPointLights = static_cast<int32_t>(count);
+
+    const size_t first = offsetof(Lights3D, numPointLights);
+    m_Upload(Binding::LIGHTS_3D, &s_Lights3D, first,
+             offsetof(Lights3D, pointLights) - first +
+                 count * sizeof(PointLight3DData));
+}
+
+void UniformBlocks::EnableFog(const bool enabled) {
+    s_Fog.enabled = enabled ? 1 : 0;
+    m_Upload(Binding::FOG, &s_Fog, offsetof(Fog, enabled), sizeof(int32_t));
+}
+
+void UniformBlocks::SetFog(const float fogStart, const float fogEnd,
+                           const Color &color) {
+    s_Fog.color = {color.r, color.g, color.b, color.a};
+    s_Fog.start = fogStart;
+    s_Fog.end = fogEnd;
+    m_Upload(Binding::FOG, &s_Fog, 0, offsetof(Fog, enabled));
+}
+} // namespace CPL
@@ -1,98 +1,26 @@
 #include "../../include/shape2D/Circle.h"
 #include "../../include/CPL.h"
 #include "../../include/Shader.h"
-#include <cmath>
-#include <numbers>
-#include <vector>
+#include "../../include/shape2D/ShapeGeometry.h"
 
 namespace CPL {
 Circle::Circle(const glm::vec2 &pos, const float radius, const Color &color)
-    : pos(pos), radius(radius), color(color) {
-    std::vector<float> vertices;
-    const int segments = std::ceil(radius);
-    static constexpr float pi = 3.14159f;
-    vertices.reserve(static_cast<int>(segments * 3));
-    for (int i = 0; i <= segments; i++) {
-        const float theta = static_cast<float>(2 * pi) /
-                            static_cast<float>(segments) *
-                            static_cast<float>(i);
-        float x = 0.0f + (radius * std::cos(theta));
-        float y = 0.0f + (radius * std::sin(theta));
-        vertices.push_back(x);
-        vertices.push_back(y);
-        vertices.push_back(0);
-    }
+    : pos(pos), radius(radius), color(color) {}
 
-    glGenVertexArrays(1, &m_OutlineVAO);
-    glGenBuffers(1, &m_OutlineVBO);
-    glBindVertexArray(m_OutlineVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_OutlineVBO);
-    glBufferData(GL_ARRAY_BUFFER,
-                 static_cast<GLsizeiptr>(vertices.size() * sizeof(float)),
-                 vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
-                          static_cast<void *>(nullptr));
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void Circle::Draw(const Shader &shader) const { m_Draw(shader, true); }
 
-    for (int i = 0; i < 3; i++) {
-        vertices.push_back(0);
-    }
-    m_VertexCount = static_cast<int>(vertices.size()) / 3;
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER,
-                 static_cast<GLsizeiptr>(vertices.size() * sizeof(float)),
-                 vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
-                          static_cast<void *>(nullptr));
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
-Circle::~Circle() {
-    if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-        glDeleteVertexArrays(1, &m_VAO);
-        m_VAO = 0;
-    }
-    if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-        glDeleteBuffers(1, &m_VBO);
-        m_VBO = 0;
-    }
-    if (m_OutlineVAO != 0 && glIsVertexArray(m_OutlineVAO)) {
-        glDeleteVertexArrays(1, &m_OutlineVAO);
-        m_OutlineVAO = 0;
-    }
-    if (m_OutlineVBO != 0 && glIsBuffer(m_OutlineVBO)) {
-        glDeleteBuffers(1, &m_OutlineVBO);
-        m_OutlineVBO = 0;
-    }
-}
+void Circle::DrawOutline(const Shader &shader) const { m_Draw(shader, false); }
 
-void Circle::Draw(const Shader &shader) const {
-    auto transform = glm::mat4(1.0f);
+void Circle::m_Draw(const Shader &shader, const bool filled) const {
+    Engine::FlushBatches();
 
-    shader.SetMatrix4fv("transform", transform);
-    shader.SetVector3f("offset", glm::vec3(pos, 0.0f));
-    shader.SetColor("inputColor", color);
-
-    glBindVertexArray(m_VAO);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, m_VertexCount);
-    glBindVertexArray(0);
-}
-
-void Circle::DrawOutline(const Shader &shader) const {
     auto transform = glm::mat4(1.0f);
+    transform = glm::translate(transform, glm::vec3(pos, 0.0f));
+    transform = glm::scale(transform, glm::vec3(radius, radius, 1.0f));
 
     shader.SetMatrix4fv("transform", transform);
-    shader.SetVector3f("offset", glm::vec3(pos, 0.0f));
+    shader.SetVector3f("offset", glm::vec3(0.0f));
     shader.SetColor("inputColor", color);
-
-    glBindVertexArray(m_OutlineVAO);
-    glDrawArrays(GL_LINE_LOOP, 0, m_VertexCount - 1);
-    glBindVertexArray(0);
+    ShapeGeometry::DrawCircle(radius, filled);
 }
 } // namespace CPL
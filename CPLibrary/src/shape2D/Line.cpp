@@ -1,5 +1,6 @@
 #include "../../include/shape2D/Line.h"
 #include "../../include/Shader.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 Line::Line(const glm::vec2 &startPos, const glm::vec2 &endPos,
@@ -12,33 +13,32 @@ Line::Line(const glm::vec2 &startPos, const glm::vec2 &endPos,
 
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(),
                  GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
                           static_cast<void *>(nullptr));
     glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 Line::~Line() {
     if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::DeleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::DeleteBuffer(m_VBO);
         m_VBO = 0;
     }
 }
 
 void Line::Draw(const Shader &shader) const {
+    Engine::FlushBatches();
+
     shader.SetMatrix4fv("transform", glm::mat4(1.0f));
     shader.SetVector3f("offset", glm::vec3(0.0f));
     shader.SetColor("inputColor", color);
-    glBindVertexArray(m_VAO);
+    GLState::BindVertexArray(m_VAO);
     glDrawArrays(GL_LINES, 0, 2);
-    glBindVertexArray(0);
 }
 } // namespace CPL
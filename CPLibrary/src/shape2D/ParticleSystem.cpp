@@ -1,27 +1,630 @@
 #include "../../include/shape2D/ParticleSystem.h"
+#include "../../include/Engine.h"
+#include "../../include/Shader.h"
+#include "../../include/shape2D/Tilemap.h"
+#include "../../include/util/BatchBuffer.h"
+#include "../../include/util/GLState.h"
+#include "../../include/util/Simd.h"
+#include "../../include/util/ThreadPool.h"
+#include <cmath>
+#include <limits>
+#include <optional>
 
 namespace CPL {
+namespace {
+// Systems created in the same order get the same particles
+uint32_t s_Systems = 0;
+
+// xorshift32, inlined into the spawn loop
+float Random01(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+}
+
+// One byte of a & b multiplied as if they were 0 to 1
+template <int shift> Simd::Int MulChannel(const Simd::Int a, const Simd::Int b) {
+    const Simd::Int byte = Simd::SetInt(0xFF);
+    const Simd::Float product = Simd::Mul(
+        Simd::ToFloat(Simd::And(Simd::ShiftRight<shift>(a), byte)),
+        Simd::ToFloat(Simd::And(Simd::ShiftRight<shift>(b), byte)));
+    return Simd::ShiftLeft<shift>(Simd::ToInt(Simd::Add(
+        Simd::Mul(product, Simd::Set(1.0f / 255.0f)), Simd::Set(0.5f))));
+}
+
+// Linear interpolation between the keys, constant before the first & after
+// the last one
+template <typename T, typename Lerp>
+T SampleCurve(const std::vector<ParticleEmitter::Key<T>> &keys, const float t,
+              Lerp lerp) {
+    if (t <= keys.front().time)
+        return keys.front().value;
+    for (size_t i = 1; i < keys.size(); i++) {
+        if (t <= keys[i].time) {
+            const auto &a = keys[i - 1];
+            const auto &b = keys[i];
+            const float span = b.time - a.time;
+            return lerp(a.value, b.value, span > 0 ? (t - a.time) / span : 1);
+        }
+    }
+    return keys.back().value;
+}
+static_assert(sizeof(ParticleSystem::Instance) == 20);
+static_assert(ParticleSystem::parallelRange % Simd::width == 0);
+} // namespace
+
+ParticleSystem::ParticleSystem(const glm::vec2 &pos, const uint32_t capacity)
+    : pos(pos), m_Capacity(capacity) {
+    const size_t padded =
+        (capacity + Simd::width - 1) / Simd::width * Simd::width;
+    for (auto *array : {&m_PosX, &m_PosY, &m_VelX, &m_VelY, &m_Age,
+                        &m_LifeTime, &m_Size, &m_Angle, &m_Spin})
+        array->resize(padded, 0.0f);
+    m_SpawnColor.resize(padded, 0);
+    m_Color.resize(padded, 0);
+    m_Texture.resize(padded, 0);
+    m_Dead.resize(1);
+    m_Dead[0].reserve(capacity);
+    m_ColorCurve.fill(0xFFFFFFFFu);
+    m_SizeCurve.fill(1.0f);
+    SetSeed(++s_Systems);
+}
+
+ParticleSystem::~ParticleSystem() { m_DeleteBuffers(); }
+
+ParticleSystem::ParticleSystem(ParticleSystem &&other) noexcept
+    : pos(other.pos), instanced(other.instanced), layer(other.layer),
+      fadeOut(other.fadeOut), collision(other.collision),
+      bounciness(other.bounciness), tilemap(other.tilemap),
+      boundsMin(other.boundsMin), boundsMax(other.boundsMax),
+      m_Count(other.m_Count), m_Capacity(other.m_Capacity),
+      m_PosX(std::move(other.m_PosX)), m_PosY(std::move(other.m_PosY)),
+      m_VelX(std::move(other.m_VelX)), m_VelY(std::move(other.m_VelY)),
+      m_Age(std::move(other.m_Age)), m_LifeTime(std::move(other.m_LifeTime)),
+      m_SpawnColor(std::move(other.m_SpawnColor)),
+      m_Color(std::move(other.m_Color)), m_Size(std::move(other.m_Size)),
+      m_Angle(std::move(other.m_Angle)), m_Spin(std::move(other.m_Spin)),
+      m_Texture(std::move(other.m_Texture)),
+      m_Textures(std::move(other.m_Textures)),
+      m_Dead(std::move(other.m_Dead)), m_Ranges(other.m_Ranges),
+      m_Emitter(std::move(other.m_Emitter)),
+      m_ColorCurve(other.m_ColorCurve), m_SizeCurve(other.m_SizeCurve),
+      m_UseCurves(other.m_UseCurves), m_Spinning(other.m_Spinning),
+      m_SpawnDebt(other.m_SpawnDebt), m_Random(other.m_Random),
+      m_VAO(other.m_VAO), m_VBO(other.m_VBO),
+      m_Instances(std::move(other.m_Instances)),
+      m_TextureStarts(std::move(other.m_TextureStarts)),
+      m_TextureEnds(std::move(other.m_TextureEnds)) {
+    other.m_Count = 0;
+    other.m_Capacity = 0;
+    other.m_VAO = 0;
+    other.m_VBO = 0;
+}
+
+ParticleSystem &ParticleSystem::operator=(ParticleSystem &&other) noexcept {
+    if (this != &other) {
+        m_DeleteBuffers();
+        pos = other.pos;
+        instanced = other.instanced;
+        layer = other.layer;
+        fadeOut = other.fadeOut;
+        collision = other.collision;
+        bounciness = other.bounciness;
+        tilemap = other.tilemap;
+        boundsMin = other.boundsMin;
+        boundsMax = other.boundsMax;
+        m_Count = other.m_Count;
+        m_Capacity = other.m_Capacity;
+        m_PosX = std::move(other.m_PosX);
+        m_PosY = std::move(other.m_PosY);
+        m_VelX = std::move(other.m_VelX);
+        m_VelY = std::move(other.m_VelY);
+        m_Age = std::move(other.m_Age);
+        m_LifeTime = std::move(other.m_LifeTime);
+        m_SpawnColor = std::move(other.m_SpawnColor);
+        m_Color = std::move(other.m_Color);
+        m_Size = std::move(other.m_Size);
+        m_Angle = std::move(other.m_Angle);
+        m_Spin = std::move(other.m_Spin);
+        m_Texture = std::move(other.m_Texture);
+        m_Textures = std::move(other.m_Textures);
+        m_Dead = std::move(other.m_Dead);
+        m_Ranges = other.m_Ranges;
+        m_Emitter = std::move(other.m_Emitter);
+        m_ColorCurve = other.m_ColorCurve;
+        m_SizeCurve = other.m_SizeCurve;
+        m_UseCurves = other.m_UseCurves;
+        m_Spinning = other.m_Spinning;
+        m_SpawnDebt = other.m_SpawnDebt;
+        m_Random = other.m_Random;
+        m_VAO = other.m_VAO;
+        m_VBO = other.m_VBO;
+        m_Instances = std::move(other.m_Instances);
+        m_TextureStarts = std::move(other.m_TextureStarts);
+        m_TextureEnds = std::move(other.m_TextureEnds);
+        other.m_Count = 0;
+        other.m_Capacity = 0;
+        other.m_VAO = 0;
+        other.m_VBO = 0;
+    }
+    return *this;
+}
+
+void ParticleSystem::m_DeleteBuffers() {
+    if (m_VAO != 0 && glIsVertexArray(m_VAO))
+        GLState::DeleteVertexArray(m_VAO);
+    if (m_VBO != 0 && glIsBuffer(m_VBO))
+        GLState::DeleteBuffer(m_VBO);
+    m_VAO = 0;
+    m_VBO = 0;
+}
+
+void ParticleSystem::SetSeed(const uint32_t seed) {
+    // xorshift gets stuck on 0
+    m_Random = seed * 0x9E3779B9u;
+    if (m_Random == 0)
+        m_Random = 0x9E3779B9u;
+}
+
+void ParticleSystem::SetEmitter(const ParticleEmitter &emitter) {
+    m_Emitter = emitter;
+    m_SpawnDebt = 0;
+
+    m_Spinning = emitter.minSpin != 0 || emitter.maxSpin != 0;
+    m_UseCurves = false;
+    for (uint32_t i = 0; i < curveSamples; i++) {
+        const float t = static_cast<float>(i) / (curveSamples - 1);
+        m_ColorCurve[i] =
+            emitter.colorCurve.empty()
+                ? 0xFFFFFFFFu
+                : SampleCurve(emitter.colorCurve, t,
+                              [](const Color &a, const Color &b,
+                                 const float f) {
+                                  return Color(a.r + (b.r - a.r) * f,
+                                               a.g + (b.g - a.g) * f,
+                                               a.b + (b.b - a.b) * f,
+                                               a.a + (b.a - a.a) * f);
+                              })
+                      .Pack();
+        m_SizeCurve[i] =
+            emitter.sizeCurve.empty()
+                ? 1.0f
+                : SampleCurve(emitter.sizeCurve, t,
+                              [](const float a, const float b, const float f) {
+                                  return a + (b - a) * f;
+                              });
+        m_UseCurves |= m_ColorCurve[i] != 0xFFFFFFFFu || m_SizeCurve[i] != 1;
+    }
+}
+
+uint32_t ParticleSystem::Emit(uint32_t count) {
+    const ParticleEmitter &emitter = m_Emitter;
+    const int texture = m_TextureIndex(emitter.tex);
+    if (texture < 0)
+        return 0;
+    count = std::min(count, m_Capacity - m_Count);
+
+    const uint32_t spawnColor = emitter.color.Pack();
+    const float lifeTimeRange = emitter.maxLifeTime - emitter.minLifeTime;
+    const float speedRange = emitter.maxSpeed - emitter.minSpeed;
+    const float rotationRange = emitter.maxRotation - emitter.minRotation;
+    const float spinRange = emitter.maxSpin - emitter.minSpin;
+    const uint32_t end = m_Count + count;
+    for (uint32_t i = m_Count; i < end; i++) {
+        m_PosX[i] = pos.x + (Random01(m_Random) - 0.5f) * emitter.area.x;
+        m_PosY[i] = pos.y + (Random01(m_Random) - 0.5f) * emitter.area.y;
+        const float angle =
+            emitter.angle + (Random01(m_Random) * 2 - 1) * emitter.spread;
+        const float speed = emitter.minSpeed + Random01(m_Random) * speedRange;
+        m_VelX[i] = std::cos(angle) * speed;
+        m_VelY[i] = std::sin(angle) * speed;
+        m_Age[i] = 0;
+        m_LifeTime[i] = emitter.minLifeTime + Random01(m_Random) * lifeTimeRange;
+        m_SpawnColor[i] = spawnColor;
+        m_Color[i] = spawnColor;
+        m_Size[i] = m_SizeCurve[0];
+        m_Angle[i] = emitter.minRotation + Random01(m_Random) * rotationRange;
+        m_Spin[i] = emitter.minSpin + Random01(m_Random) * spinRange;
+        m_Texture[i] = static_cast<uint16_t>(texture);
+    }
+    m_Count = end;
+    return count;
+}
+
 void ParticleSystem::Update() {
-    for (auto &p : particles) {
-        p.Update();
-        if (p.curLifeTime > p.lifeTime) {
-            p.active = false;
+    const float deltaTime = GetDeltaTime();
+    // Moved from systems have no dead list
+    if (m_Dead.empty())
+        m_Dead.emplace_back();
+    m_Ranges = 1;
+    m_Simulate(0, m_Count, deltaTime, m_Dead[0]);
+    m_Finish(deltaTime);
+}
+
+void ParticleSystem::UpdateParallel(
+    const std::vector<ParticleSystem *> &systems) {
+    UpdateParallel(systems, ThreadPool::GetShared());
+}
+
+void ParticleSystem::UpdateParallel(
+    const std::vector<ParticleSystem *> &systems, ThreadPool &pool) {
+    struct Task {
+        ParticleSystem *system;
+        uint32_t range;
+    };
+    std::vector<Task> tasks;
+    for (ParticleSystem *system : systems) {
+        system->m_Ranges = std::max(
+            (system->m_Count + parallelRange - 1) / parallelRange, 1u);
+        if (system->m_Dead.size() < system->m_Ranges)
+            system->m_Dead.resize(system->m_Ranges);
+        for (uint32_t range = 0; range < system->m_Ranges; range++)
+            tasks.push_back({system, range});
+    }
+
+    // Every range only touches its own particles & dead list
+    const float deltaTime = GetDeltaTime();
+    pool.ParallelFor(static_cast<uint32_t>(tasks.size()),
+                     [&](const uint32_t i) {
+                         ParticleSystem &system = *tasks[i].system;
+                         const uint32_t first = tasks[i].range * parallelRange;
+                         const uint32_t end =
+                             std::min(first + parallelRange, system.m_Count);
+                         system.m_Simulate(first, end, deltaTime,
+                                           system.m_Dead[tasks[i].range]);
+                     });
+    // Removing & spawning only touches the system itself
+    pool.ParallelFor(static_cast<uint32_t>(systems.size()),
+                     [&](const uint32_t i) { systems[i]->m_Finish(deltaTime); });
+}
+
+void ParticleSystem::m_Simulate(const uint32_t first, const uint32_t end,
+                                const float deltaTime,
+                                std::vector<uint32_t> &dead) {
+    const Simd::Float dt = Simd::Set(deltaTime);
+    const Simd::Float zero = Simd::Set(0.0f);
+    const Simd::Float one = Simd::Set(1.0f);
+    const Simd::Float half = Simd::Set(0.5f);
+    const Simd::Int rgbMask = Simd::SetInt(0x00FFFFFFu);
+
+    const bool accelerate = m_Emitter.gravity != glm::vec2(0.0f) ||
+                            m_Emitter.drag != 0.0f;
+    const Simd::Float gravityX = Simd::Set(m_Emitter.gravity.x * deltaTime);
+    const Simd::Float gravityY = Simd::Set(m_Emitter.gravity.y * deltaTime);
+    const Simd::Float drag =
+        Simd::Set(std::max(0.0f, 1.0f - m_Emitter.drag * deltaTime));
+    const Simd::Float lastSample = Simd::Set(curveSamples - 1);
+    const bool collide =
+        collision != ParticleCollision::NONE &&
+        (tilemap != nullptr ||
+         (boundsMax.x > boundsMin.x && boundsMax.y > boundsMin.y));
+    // Only built if used, it is cleared on construction
+    std::optional<CellCache> cache;
+    if (collide && tilemap != nullptr &&
+        tilemap->GetTileSize() != glm::vec2(0.0f)) {
+        cache.emplace();
+        cache->tileSize = tilemap->GetTileSize();
+        cache->invTileSize = 1.0f / cache->tileSize;
+    }
+
+    dead.clear();
+    for (uint32_t i = first; i < end; i += Simd::width) {
+        const Simd::Float age = Simd::Add(Simd::Load(&m_Age[i]), dt);
+        const Simd::Float lifeTime = Simd::Load(&m_LifeTime[i]);
+        Simd::Store(&m_Age[i], age);
+
+        Simd::Float velX = Simd::Load(&m_VelX[i]);
+        Simd::Float velY = Simd::Load(&m_VelY[i]);
+        if (accelerate) {
+            velX = Simd::Mul(Simd::Add(velX, gravityX), drag);
+            velY = Simd::Mul(Simd::Add(velY, gravityY), drag);
+            Simd::Store(&m_VelX[i], velX);
+            Simd::Store(&m_VelY[i], velY);
+        }
+        Simd::Store(&m_PosX[i],
+                    Simd::Add(Simd::Load(&m_PosX[i]), Simd::Mul(velX, dt)));
+        Simd::Store(&m_PosY[i],
+                    Simd::Add(Simd::Load(&m_PosY[i]), Simd::Mul(velY, dt)));
+        if (m_Spinning) {
+            Simd::Store(&m_Angle[i],
+                        Simd::Add(Simd::Load(&m_Angle[i]),
+                                  Simd::Mul(Simd::Load(&m_Spin[i]), dt)));
+        }
+        if (collide)
+            m_Collide(i, std::min(i + Simd::width, end), deltaTime,
+                      cache ? &*cache : nullptr);
+
+        // Part of the lifetime that has passed, 0 to 1
+        const Simd::Float t =
+            Simd::Max(Simd::Min(Simd::Div(age, lifeTime), one), zero);
+        Simd::Int color = Simd::LoadInt(&m_SpawnColor[i]);
+        if (m_UseCurves) {
+            // No gather below AVX2, so the table lookups are scalar
+            std::array<uint32_t, Simd::width> samples;
+            std::array<uint32_t, Simd::width> curveColor;
+            std::array<float, Simd::width> curveSize;
+            Simd::StoreInt(samples.data(),
+                           Simd::ToInt(Simd::Add(Simd::Mul(t, lastSample),
+                                                 half)));
+            for (uint32_t lane = 0; lane < Simd::width; lane++) {
+                const uint32_t sample =
+                    std::min(samples[lane], curveSamples - 1);
+                curveColor[lane] = m_ColorCurve[sample];
+                curveSize[lane] = m_SizeCurve[sample];
+            }
+            Simd::Store(&m_Size[i], Simd::Load(curveSize.data()));
+            const Simd::Int curve = Simd::LoadInt(curveColor.data());
+            color = Simd::Or(
+                Simd::Or(MulChannel<0>(color, curve),
+                         MulChannel<8>(color, curve)),
+                Simd::Or(MulChannel<16>(color, curve),
+                         MulChannel<24>(color, curve)));
+        }
+        if (fadeOut) {
+            const Simd::Float alpha =
+                Simd::Mul(Simd::ToFloat(Simd::ShiftRight<24>(color)),
+                          Simd::Sub(one, t));
+            color = Simd::Or(
+                Simd::And(color, rgbMask),
+                Simd::ShiftLeft<24>(Simd::ToInt(Simd::Add(alpha, half))));
+        }
+        Simd::StoreInt(&m_Color[i], color);
+
+        // Dying is rare, so lanes are only looked at if one died.
+        // Killed by a collision sets the age to infinity
+        int died = Simd::MoveMask(Simd::Greater(
+            collide ? Simd::Load(&m_Age[i]) : age, lifeTime));
+        for (uint32_t lane = 0; died != 0; lane++, died >>= 1) {
+            if ((died & 1) != 0 && i + lane < end)
+                dead.push_back(i + lane);
+        }
+    }
+}
+
+void ParticleSystem::m_Collide(const uint32_t first, const uint32_t end,
+                               const float deltaTime,
+                               CellCache *const cache) {
+    const bool bounded =
+        boundsMax.x > boundsMin.x && boundsMax.y > boundsMin.y;
+    const auto solid = [&](const glm::vec2 &point) {
+        if (cache == nullptr)
+            return tilemap->TileAt(point) >= 0;
+        // Truncate & step down for negatives, std::floor is a libm call
+        // without SSE4.1
+        const glm::vec2 scaled = point * cache->invTileSize;
+        glm::ivec2 cell(scaled);
+        cell.x -= scaled.x < static_cast<float>(cell.x) ? 1 : 0;
+        cell.y -= scaled.y < static_cast<float>(cell.y) ? 1 : 0;
+        constexpr int mask = (1 << CellCache::bits) - 1;
+        CellCache::Entry &entry =
+            cache->entries[(cell.x & mask) |
+                           (cell.y & mask) << CellCache::bits];
+        if (!entry.used || entry.cell != cell) {
+            entry.cell = cell;
+            entry.solid = tilemap->FindTile(glm::vec2(cell) * cache->tileSize,
+                                            cache->tileSize) >= 0;
+            entry.used = true;
+        }
+        return entry.solid;
+    };
+    for (uint32_t i = first; i < end; i++) {
+        // Same center the particles are scaled & rotated around
+        const glm::vec2 half = m_Textures[m_Texture[i]]->size * 0.5f;
+        const glm::vec2 center(m_PosX[i] + half.x, m_PosY[i] + half.y);
+        const glm::vec2 velocity(m_VelX[i], m_VelY[i]);
+        const glm::vec2 last = center - velocity * deltaTime;
+
+        bool hitX = false;
+        bool hitY = false;
+        if (tilemap != nullptr && solid(center)) {
+            // The axis whose move alone leads into the tile was hit
+            if (!solid({last.x, center.y}))
+                hitX = true;
+            else if (!solid({center.x, last.y}))
+                hitY = true;
+            else
+                hitX = hitY = true;
+        }
+        if (bounded) {
+            hitX |= center.x < boundsMin.x || center.x > boundsMax.x;
+            hitY |= center.y < boundsMin.y || center.y > boundsMax.y;
+        }
+        if (!hitX && !hitY)
+            continue;
+
+        switch (collision) {
+        case ParticleCollision::BOUNCE:
+            if (hitX) {
+                m_PosX[i] = last.x - half.x;
+                m_VelX[i] = -velocity.x * bounciness;
+            }
+            if (hitY) {
+                m_PosY[i] = last.y - half.y;
+                m_VelY[i] = -velocity.y * bounciness;
+            }
+            break;
+        case ParticleCollision::STICK:
+            m_PosX[i] = last.x - half.x;
+            m_PosY[i] = last.y - half.y;
+            m_VelX[i] = 0;
+            m_VelY[i] = 0;
+            m_Spin[i] = 0;
+            break;
+        case ParticleCollision::KILL:
+            m_Age[i] = std::numeric_limits<float>::infinity();
+            break;
+        case ParticleCollision::NONE:
+            break;
         }
     }
-    particles.erase(std::remove_if(particles.begin(), particles.end(),
-                                   [](const Particle &p) { return !p.active; }),
-                    particles.end());
+}
+
+void ParticleSystem::m_Finish(const float deltaTime) {
+    // From the back, so the particle moved into a hole is always alive
+    for (uint32_t range = m_Ranges; range-- > 0;) {
+        for (auto it = m_Dead[range].rbegin(); it != m_Dead[range].rend();
+             ++it)
+            m_Remove(*it);
+        m_Dead[range].clear();
+    }
+
+    if (m_Emitter.rate > 0 && m_Emitter.tex != nullptr) {
+        m_SpawnDebt += m_Emitter.rate * deltaTime;
+        const auto spawn = static_cast<uint32_t>(m_SpawnDebt);
+        m_SpawnDebt -= static_cast<float>(spawn);
+        Emit(spawn);
+    }
+}
+
+void ParticleSystem::m_Remove(const uint32_t index) {
+    const uint32_t last = --m_Count;
+    if (index == last)
+        return;
+    m_PosX[index] = m_PosX[last];
+    m_PosY[index] = m_PosY[last];
+    m_VelX[index] = m_VelX[last];
+    m_VelY[index] = m_VelY[last];
+    m_Age[index] = m_Age[last];
+    m_LifeTime[index] = m_LifeTime[last];
+    m_SpawnColor[index] = m_SpawnColor[last];
+    m_Color[index] = m_Color[last];
+    m_Size[index] = m_Size[last];
+    m_Angle[index] = m_Angle[last];
+    m_Spin[index] = m_Spin[last];
+    m_Texture[index] = m_Texture[last];
 }
 
 void ParticleSystem::Draw() {
-    for (auto &p : particles) {
-        DrawTex2D(p.particleTex, p.pos, p.color);
+    if (m_Count == 0)
+        return;
+    if (instanced)
+        m_DrawInstanced();
+    else
+        m_DrawBatched();
+}
+
+void ParticleSystem::m_DrawBatched() {
+    for (uint32_t i = 0; i < m_Count; i++) {
+        Texture2D *const tex = m_Textures[m_Texture[i]];
+        const uint32_t color = m_Color[i];
+        // DrawTex2D draws with the texture size, scale around the center
+        const glm::vec2 size = tex->size;
+        tex->size = size * m_Size[i];
+        DrawTex2DRot(tex,
+                     glm::vec2(m_PosX[i], m_PosY[i]) + (size - tex->size) * 0.5f,
+                     m_Angle[i],
+                     Color(static_cast<float>(color & 0xFF),
+                           static_cast<float>((color >> 8) & 0xFF),
+                           static_cast<float>((color >> 16) & 0xFF),
+                           static_cast<float>(color >> 24)),
+                     layer);
+        tex->size = size;
+    }
+}
+
+void ParticleSystem::m_DrawInstanced() {
+    if (m_VAO == 0) {
+        m_Instances.resize(m_Capacity);
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(1, &m_VBO);
+        GLState::BindVertexArray(m_VAO);
+        GLState::BindArrayBuffer(m_VBO);
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(m_Capacity * sizeof(Instance)),
+                     nullptr, GL_STREAM_DRAW);
+        for (uint32_t attribute = 0; attribute < 3; attribute++) {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+    }
+
+    // Group the instances by texture (counting sort)
+    m_TextureStarts.assign(m_Textures.size(), 0);
+    for (uint32_t i = 0; i < m_Count; i++)
+        m_TextureStarts[m_Texture[i]]++;
+    uint32_t offset = 0;
+    for (uint32_t &start : m_TextureStarts) {
+        const uint32_t count = start;
+        start = offset;
+        offset += count;
+    }
+    m_TextureEnds = m_TextureStarts;
+    for (uint32_t i = 0; i < m_Count; i++) {
+        m_Instances[m_TextureEnds[m_Texture[i]]++] = {
+            {m_PosX[i], m_PosY[i]}, m_Size[i], m_Angle[i], m_Color[i]};
+    }
+
+    // Keep the order with everything drawn before
+    Engine::FlushBatches();
+
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
+    BatchBuffer::Upload(m_Capacity * sizeof(Instance), m_Instances.data(),
+                        m_Count * sizeof(Instance));
+
+    const Shader &shader = Engine::GetParticleShader();
+    shader.Use();
+    for (size_t t = 0; t < m_Textures.size(); t++) {
+        const uint32_t first = m_TextureStarts[t];
+        const uint32_t count = m_TextureEnds[t] - first;
+        if (count == 0)
+            continue;
+        const Texture2D *tex = m_Textures[t];
+        GLState::BindTexture(0, GL_TEXTURE_2D, tex->tex);
+        shader.SetVector2f("quadSize", tex->size);
+        shader.SetVector4f("uvRect", tex->uvRect);
+
+        // No base instance in GL 3.3, so the attributes start at the run
+        const size_t base = first * sizeof(Instance);
+        glVertexAttribPointer(
+            0, 2, GL_FLOAT, GL_FALSE, sizeof(Instance),
+            reinterpret_cast<void *>(base + offsetof(Instance, pos)));
+        glVertexAttribPointer(
+            1, 2, GL_FLOAT, GL_FALSE, sizeof(Instance),
+            reinterpret_cast<void *>(base + offsetof(Instance, size)));
+        glVertexAttribPointer(
+            2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance),
+            reinterpret_cast<void *>(base + offsetof(Instance, color)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                              static_cast<GLsizei>(count));
     }
+    Engine::ResetShader();
 }
 
-void ParticleSystem::AddParticle(Texture2D *const tex, const Color &color,
+int ParticleSystem::m_TextureIndex(Texture2D *const tex) {
+    if (tex == nullptr)
+        return -1;
+    // Systems use very few textures, so a linear search is enough
+    const auto it = std::find(m_Textures.begin(), m_Textures.end(), tex);
+    if (it != m_Textures.end())
+        return static_cast<int>(it - m_Textures.begin());
+    if (m_Textures.size() > UINT16_MAX)
+        return -1;
+    m_Textures.push_back(tex);
+    return static_cast<int>(m_Textures.size() - 1);
+}
+
+bool ParticleSystem::AddParticle(Texture2D *const tex, const Color &color,
                                  const float lifeTime, const glm::vec2 &dir,
                                  const glm::vec2 &off) {
-    particles.emplace_back(pos + off, tex, color, lifeTime, dir);
+    const int texture = m_TextureIndex(tex);
+    if (m_Count >= m_Capacity || texture < 0)
+        return false;
+
+    const uint32_t i = m_Count++;
+    m_PosX[i] = pos.x + off.x;
+    m_PosY[i] = pos.y + off.y;
+    m_VelX[i] = dir.x;
+    m_VelY[i] = dir.y;
+    m_Age[i] = 0;
+    m_LifeTime[i] = lifeTime;
+    m_SpawnColor[i] = color.Pack();
+    m_Color[i] = m_SpawnColor[i];
+    m_Size[i] = m_SizeCurve[0];
+    m_Angle[i] = 0;
+    m_Spin[i] = 0;
+    m_Texture[i] = static_cast<uint16_t>(texture);
+    return true;
 }
 } // namespace CPL
@@ -1,6 +1,7 @@
 #include "../../include/shape2D/ScreenQuad.h"
 #include "../../include/Engine.h"
 #include "../../include/Shader.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 void ScreenQuad::Init(const int width, const int height) {
@@ -18,8 +19,8 @@ void ScreenQuad::Init(const int width, const int height) {
 
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
@@ -35,7 +36,7 @@ void ScreenQuad::Init(const int width, const int height) {
     glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
 
     glGenTextures(1, &m_TextureColorBuffer);
-    glBindTexture(GL_TEXTURE_2D, m_TextureColorBuffer);
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_TextureColorBuffer);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<int>(size.x), static_cast<int>(size.y), 0, GL_RGB,
                  GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -68,15 +69,15 @@ void ScreenQuad::Draw(const int mode) const {
     Engine::GetScreenQuadShader().Use();
     Engine::GetScreenQuadShader().SetInt("postProcessingMode", mode);
 
-    glBindVertexArray(m_VAO);
-    glBindTexture(GL_TEXTURE_2D, m_TextureColorBuffer);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_TextureColorBuffer);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 void ScreenQuad::DrawCustom(const Shader &shader) const {
     shader.Use();
 
-    glBindVertexArray(m_VAO);
-    glBindTexture(GL_TEXTURE_2D, m_TextureColorBuffer);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_TextureColorBuffer);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 } // namespace CPL
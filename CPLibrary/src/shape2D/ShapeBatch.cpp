@@ -0,0 +1,186 @@
+#include "../../include/shape2D/ShapeBatch.h"
+#include "../../include/CPL.h"
+#include "../../include/Shader.h"
+#include "../../include/shape2D/ShapeGeometry.h"
+#include "../../include/util/BatchBuffer.h"
+#include "../../include/util/GLState.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace CPL {
+namespace {
+glm::vec2 Rotate(const glm::vec2 &point, const glm::vec2 &center,
+                 const float cosA, const float sinA) {
+    const glm::vec2 d = point - center;
+    return {center.x + (d.x * cosA) - (d.y * sinA),
+            center.y + (d.x * sinA) + (d.y * cosA)};
+}
+} // namespace
+
+ShapeBatch::~ShapeBatch() {
+    if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
+        GLState::DeleteVertexArray(m_VAO);
+        m_VAO = 0;
+    }
+    if (m_VBO != 0 && glIsBuffer(m_VBO)) {
+        GLState::DeleteBuffer(m_VBO);
+        m_VBO = 0;
+    }
+}
+
+void ShapeBatch::Init(const uint32_t maxVertices) {
+    m_MaxVertices = maxVertices;
+    m_Vertices.reserve(maxVertices);
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(maxVertices * sizeof(Vertex)),
+                 nullptr, GL_STREAM_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, color)));
+    glEnableVertexAttribArray(1);
+}
+
+ShapeBatch::Vertex *ShapeBatch::m_Reserve(const Shader &shader,
+                                          const Primitive primitive,
+                                          const uint32_t count) {
+    if (m_Shader != &shader || m_Primitive != primitive ||
+        m_Vertices.size() + count > m_MaxVertices) {
+        Flush();
+        m_Shader = &shader;
+        m_Primitive = primitive;
+    }
+    const size_t first = m_Vertices.size();
+    m_Vertices.resize(first + count);
+    return m_Vertices.data() + first;
+}
+
+void ShapeBatch::AddRect(const Shader &shader, const glm::vec2 &pos,
+                         const glm::vec2 &size, const float angle,
+                         const Color &color, const bool filled) {
+    std::array<glm::vec2, 4> corners = {
+        glm::vec2(pos.x + size.x, pos.y),
+        glm::vec2(pos.x + size.x, pos.y + size.y),
+        glm::vec2(pos.x, pos.y + size.y),
+        glm::vec2(pos.x, pos.y),
+    };
+    if (angle != 0.0f) {
+        const glm::vec2 center = pos + (size * 0.5f);
+        const float rad = glm::radians(angle);
+        const float cosA = std::cos(rad);
+        const float sinA = std::sin(rad);
+        for (auto &c : corners)
+            c = Rotate(c, center, cosA, sinA);
+    }
+
+    const uint32_t packed = color.Pack();
+    if (filled) {
+        Vertex *v = m_Reserve(shader, Primitive::TRIANGLES, 6);
+        constexpr std::array<uint32_t, 6> indices = {0, 1, 3, 1, 2, 3};
+        for (uint32_t i = 0; i < 6; i++)
+            v[i] = {corners[indices[i]], packed};
+    } else {
+        Vertex *v = m_Reserve(shader, Primitive::LINES, 8);
+        for (uint32_t i = 0; i < 4; i++) {
+            v[i * 2] = {corners[i], packed};
+            v[(i * 2) + 1] = {corners[(i + 1) % 4], packed};
+        }
+    }
+}
+
+void ShapeBatch::AddTriangle(const Shader &shader, const glm::vec2 &pos,
+                             const glm::vec2 &size, const float angle,
+                             const Color &color, const bool filled) {
+    std::array<glm::vec2, 3> corners = {
+        glm::vec2(pos.x, pos.y),
+        glm::vec2(pos.x + size.x, pos.y),
+        glm::vec2(pos.x + (size.x / 2), pos.y + size.y),
+    };
+    if (angle != 0.0f) {
+        const glm::vec2 center = pos + (size * 0.5f);
+        const float rad = -glm::radians(angle);
+        const float cosA = std::cos(rad);
+        const float sinA = std::sin(rad);
+        for (auto &c : corners)
+            c = Rotate(c, center, cosA, sinA);
+    }
+
+    const uint32_t packed = color.Pack();
+    if (filled) {
+        Vertex *v = m_Reserve(shader, Primitive::TRIANGLES, 3);
+        for (uint32_t i = 0; i < 3; i++)
+            v[i] = {corners[i], packed};
+    } else {
+        Vertex *v = m_Reserve(shader, Primitive::LINES, 6);
+        for (uint32_t i = 0; i < 3; i++) {
+            v[i * 2] = {corners[i], packed};
+            v[(i * 2) + 1] = {corners[(i + 1) % 3], packed};
+        }
+    }
+}
+
+void ShapeBatch::AddCircle(const Shader &shader, const glm::vec2 &pos,
+                           const float radius, const Color &color,
+                           const bool filled) {
+    // Same resolution as CPL::Circle
+    const uint32_t segments = ShapeGeometry::GetCircleSegments(radius);
+    static constexpr float pi = 3.14159f;
+    const float step = 2 * pi / static_cast<float>(segments);
+    const float cosStep = std::cos(step);
+    const float sinStep = std::sin(step);
+    const uint32_t packed = color.Pack();
+
+    // Walk around the circle by rotating the previous point instead of
+    // calling cos/sin per segment
+    glm::vec2 dir = {radius, 0.0f};
+    Vertex *v = m_Reserve(shader,
+                          filled ? Primitive::TRIANGLES : Primitive::LINES,
+                          segments * (filled ? 3 : 2));
+    for (uint32_t i = 0; i < segments; i++) {
+        const glm::vec2 next = {(dir.x * cosStep) - (dir.y * sinStep),
+                                (dir.x * sinStep) + (dir.y * cosStep)};
+        if (filled) {
+            *v++ = {pos, packed};
+            *v++ = {pos + dir, packed};
+            *v++ = {pos + next, packed};
+        } else {
+            *v++ = {pos + dir, packed};
+            *v++ = {pos + next, packed};
+        }
+        dir = next;
+    }
+}
+
+void ShapeBatch::AddLine(const Shader &shader, const glm::vec2 &startPos,
+                         const glm::vec2 &endPos, const Color &color) {
+    const uint32_t packed = color.Pack();
+    Vertex *v = m_Reserve(shader, Primitive::LINES, 2);
+    v[0] = {startPos, packed};
+    v[1] = {endPos, packed};
+}
+
+void ShapeBatch::Flush() {
+    if (m_Vertices.empty() || m_Shader == nullptr)
+        return;
+
+    m_Shader->Use();
+
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
+    BatchBuffer::Upload(
+        std::max<size_t>(m_MaxVertices, m_Vertices.size()) * sizeof(Vertex),
+        m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
+    glDrawArrays(m_Primitive == Primitive::TRIANGLES ? GL_TRIANGLES : GL_LINES,
+                 0, static_cast<GLsizei>(m_Vertices.size()));
+
+    m_Vertices.clear();
+    m_DrawCalls++;
+}
+} // namespace CPL
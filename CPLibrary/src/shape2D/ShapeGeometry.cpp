@@ -0,0 +1,101 @@
+#include "../../include/shape2D/ShapeGeometry.h"
+#include "../../include/util/GLState.h"
+#include <cmath>
+#include <vector>
+
+namespace CPL {
+uint32_t ShapeGeometry::s_VAO = 0, ShapeGeometry::s_VBO = 0;
+ShapeGeometry::Mesh ShapeGeometry::s_Quad, ShapeGeometry::s_Triangle;
+std::array<ShapeGeometry::Mesh, ShapeGeometry::circleLODs.size()>
+    ShapeGeometry::s_Circles;
+
+void ShapeGeometry::Init() {
+    if (s_VAO != 0)
+        return;
+
+    std::vector<glm::vec2> vertices;
+    const auto addMesh = [&vertices](std::initializer_list<glm::vec2> points) {
+        Mesh mesh;
+        mesh.first = static_cast<int>(vertices.size());
+        mesh.count = static_cast<int>(points.size());
+        vertices.insert(vertices.end(), points);
+        return mesh;
+    };
+
+    // Same winding as the old per shape buffers
+    s_Quad = addMesh({{1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}});
+    s_Triangle = addMesh({{0.0f, 0.0f}, {1.0f, 0.0f}, {0.5f, 1.0f}});
+
+    // Center first, then the outline (first point repeated to close the fan)
+    static constexpr float pi = 3.14159f;
+    for (size_t lod = 0; lod < circleLODs.size(); lod++) {
+        const uint32_t segments = circleLODs[lod];
+        s_Circles[lod].first = static_cast<int>(vertices.size());
+        s_Circles[lod].count = static_cast<int>(segments);
+        vertices.emplace_back(0.0f, 0.0f);
+        for (uint32_t i = 0; i <= segments; i++) {
+            const float theta = 2 * pi / static_cast<float>(segments) *
+                                static_cast<float>(i);
+            vertices.emplace_back(std::cos(theta), std::sin(theta));
+        }
+    }
+
+    glGenVertexArrays(1, &s_VAO);
+    glGenBuffers(1, &s_VBO);
+    GLState::BindVertexArray(s_VAO);
+    GLState::BindArrayBuffer(s_VBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec2)),
+                 vertices.data(), GL_STATIC_DRAW);
+    // aPos is a vec3 in the shape shaders, z defaults to 0
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2),
+                          static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+}
+
+void ShapeGeometry::Destroy() {
+    if (s_VAO != 0 && glIsVertexArray(s_VAO)) {
+        GLState::DeleteVertexArray(s_VAO);
+    }
+    if (s_VBO != 0 && glIsBuffer(s_VBO)) {
+        GLState::DeleteBuffer(s_VBO);
+    }
+    s_VAO = 0;
+    s_VBO = 0;
+}
+
+void ShapeGeometry::DrawQuad(const bool filled) {
+    GLState::BindVertexArray(s_VAO);
+    glDrawArrays(filled ? GL_TRIANGLE_FAN : GL_LINE_LOOP, s_Quad.first,
+                 s_Quad.count);
+}
+
+void ShapeGeometry::DrawTriangle(const bool filled) {
+    GLState::BindVertexArray(s_VAO);
+    glDrawArrays(filled ? GL_TRIANGLES : GL_LINE_LOOP, s_Triangle.first,
+                 s_Triangle.count);
+}
+
+void ShapeGeometry::DrawCircle(const float radius, const bool filled) {
+    const Mesh &mesh = s_Circles[m_GetCircleLOD(radius)];
+    GLState::BindVertexArray(s_VAO);
+    if (filled) {
+        glDrawArrays(GL_TRIANGLE_FAN, mesh.first, mesh.count + 2);
+    } else {
+        glDrawArrays(GL_LINE_LOOP, mesh.first + 1, mesh.count);
+    }
+}
+
+uint32_t ShapeGeometry::GetCircleSegments(const float radius) {
+    return circleLODs[m_GetCircleLOD(radius)];
+}
+
+size_t ShapeGeometry::m_GetCircleLOD(const float radius) {
+    const float segments = std::ceil(radius);
+    for (size_t lod = 0; lod < circleLODs.size(); lod++) {
+        if (static_cast<float>(circleLODs[lod]) >= segments)
+            return lod;
+    }
+    return circleLODs.size() - 1;
+}
+} // namespace CPL
@@ -0,0 +1,141 @@
+#include "../../include/shape2D/SpriteBatch.h"
+#include "../../include/CPL.h"
+#include "../../include/Shader.h"
+#include "../../include/util/BatchBuffer.h"
+#include "../../include/util/GLState.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace CPL {
+SpriteBatch::~SpriteBatch() {
+    if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
+        GLState::DeleteVertexArray(m_VAO);
+        m_VAO = 0;
+    }
+    if (m_VBO != 0 && glIsBuffer(m_VBO)) {
+        GLState::DeleteBuffer(m_VBO);
+        m_VBO = 0;
+    }
+    if (m_EBO != 0 && glIsBuffer(m_EBO)) {
+        GLState::DeleteBuffer(m_EBO);
+        m_EBO = 0;
+    }
+}
+
+void SpriteBatch::Init(const uint32_t maxSprites) {
+    m_MaxSprites = maxSprites;
+    m_Sprites.reserve(maxSprites);
+    m_Vertices.reserve(static_cast<size_t>(maxSprites) * 4);
+    m_Sorted.reserve(static_cast<size_t>(maxSprites) * 4);
+
+    // Same quad layout as Texture2D for every sprite
+    std::vector<uint32_t> indices;
+    indices.reserve(static_cast<size_t>(maxSprites) * 6);
+    for (uint32_t i = 0; i < maxSprites; i++) {
+        const uint32_t v = i * 4;
+        indices.insert(indices.end(), {v, v + 1, v + 3, v + 1, v + 2, v + 3});
+    }
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(maxSprites * 4 * sizeof(Vertex)),
+                 nullptr, GL_STREAM_DRAW);
+    GLState::BindElementBuffer(m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)),
+                 indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, uv)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, color)));
+    glEnableVertexAttribArray(2);
+}
+
+uint64_t SpriteBatch::MakeSortKey(const int layer, const uint32_t texture,
+                                  const bool byTexture) {
+    // Flip the sign bit so negative layers sort before positive ones
+    const uint32_t biasedLayer = static_cast<uint32_t>(layer) ^ 0x80000000u;
+    // Without the texture the stable sort keeps submission order
+    return (static_cast<uint64_t>(biasedLayer) << 32) |
+           (byTexture ? texture : 0);
+}
+
+void SpriteBatch::SetSortByTexture(const bool enabled) {
+    Flush();
+    m_SortByTexture = enabled;
+}
+
+void SpriteBatch::Add(const Shader &shader, const uint32_t texture,
+                      const int layer, const glm::vec2 &pos,
+                      const glm::vec2 &size, const float angle,
+                      const glm::vec4 &uvRect, const Color &color) {
+    if (m_Shader != &shader || m_Sprites.size() >= m_MaxSprites) {
+        Flush();
+        m_Shader = &shader;
+    }
+
+    // Same corners & texture coordinates as the Texture2D quad
+    std::array<glm::vec2, 4> corners = {
+        glm::vec2(pos.x + size.x, pos.y),
+        glm::vec2(pos.x + size.x, pos.y + size.y),
+        glm::vec2(pos.x, pos.y + size.y),
+        glm::vec2(pos.x, pos.y),
+    };
+    if (angle != 0.0f) {
+        const glm::vec2 center = pos + (size * 0.5f);
+        const float rad = glm::radians(angle);
+        const float cosA = std::cos(rad);
+        const float sinA = std::sin(rad);
+        for (auto &c : corners) {
+            const glm::vec2 d = c - center;
+            c = {center.x + (d.x * cosA) - (d.y * sinA),
+                 center.y + (d.x * sinA) + (d.y * cosA)};
+        }
+    }
+
+    const uint32_t packed = color.Pack();
+    m_Sprites.push_back({MakeSortKey(layer, texture, m_SortByTexture),
+                         texture, static_cast<uint32_t>(m_Vertices.size())});
+    m_Vertices.push_back({corners[0], {uvRect.z, uvRect.w}, packed});
+    m_Vertices.push_back({corners[1], {uvRect.z, uvRect.y}, packed});
+    m_Vertices.push_back({corners[2], {uvRect.x, uvRect.y}, packed});
+    m_Vertices.push_back({corners[3], {uvRect.x, uvRect.w}, packed});
+}
+
+void SpriteBatch::Flush() {
+    if (m_Sprites.empty() || m_Shader == nullptr)
+        return;
+
+    BatchBuffer::SortItems(m_Sprites, m_Vertices, 4, m_Sorted);
+
+    m_Shader->Use();
+
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
+    BatchBuffer::Upload(static_cast<size_t>(m_MaxSprites) * 4 * sizeof(Vertex),
+                        m_Sorted.data(), m_Sorted.size() * sizeof(Vertex));
+
+    // One draw per run of sprites sharing a texture
+    BatchBuffer::ForEachRun(
+        m_Sprites, [](const Sprite &s) { return s.texture; },
+        [&](const Sprite &s, const size_t first, const size_t count) {
+            GLState::BindTexture(0, GL_TEXTURE_2D, s.texture);
+            glDrawElements(
+                GL_TRIANGLES, static_cast<GLsizei>(count * 6), GL_UNSIGNED_INT,
+                reinterpret_cast<void *>(first * 6 * sizeof(uint32_t)));
+            m_DrawCalls++;
+        });
+
+    m_Sprites.clear();
+    m_Vertices.clear();
+}
+} // namespace CPL
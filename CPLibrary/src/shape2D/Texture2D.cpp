@@ -1,5 +1,6 @@
 #include "../../include/shape2D/Texture2D.h"
 #include "../../include/Shader.h"
+#include "../../include/util/GLState.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -17,13 +18,20 @@ Texture2D::Texture2D(const std::string &filePath, const glm::vec2 &size,
     m_Load(filePath, textureFiltering);
 }
 
-void Texture2D::m_Load(const std::string &filePath, const TextureFiltering &textureFiltering) {
+Texture2D::Texture2D(const uint32_t texture, const glm::vec4 &uvRect,
+                     const glm::vec2 &textureSize)
+    : pos(0.0f), size(textureSize), textureSize(textureSize), color(WHITE),
+      tex(texture), uvRect(uvRect), m_OwnsTexture(false) {
+    m_CreateQuad();
+}
+
+void Texture2D::m_CreateQuad() {
     const std::array<float, 20> vertices = {
-        size.x, 0.0f,   0.0f,  1.0f, 1.0f,
-        size.x, size.y, 0.0f,  1.0f, 0.0f,
+        size.x, 0.0f,   0.0f,  uvRect.z, uvRect.w,
+        size.x, size.y, 0.0f,  uvRect.z, uvRect.y,
 
-        0.0f,   size.y, 0.0f,  0.0f, 0.0f,
-        0.0f,   0.0f,   0.0f,  0.0f, 1.0f
+        0.0f,   size.y, 0.0f,  uvRect.x, uvRect.y,
+        0.0f,   0.0f,   0.0f,  uvRect.x, uvRect.w
     };
     constexpr std::array<uint32_t, 6> indices = {
         0, 1, 3, 
@@ -33,10 +41,10 @@ void Texture2D::m_Load(const std::string &filePath, const TextureFiltering &text
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    GLState::BindElementBuffer(m_EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices.data(),
                  GL_STATIC_DRAW);
 
@@ -47,12 +55,13 @@ void Texture2D::m_Load(const std::string &filePath, const TextureFiltering &text
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
                           reinterpret_cast<void *>(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void Texture2D::m_Load(const std::string &filePath, const TextureFiltering &textureFiltering) {
+    m_CreateQuad();
 
     glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    GLState::BindTexture(0, GL_TEXTURE_2D, tex);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
@@ -89,15 +98,20 @@ void Texture2D::m_Load(const std::string &filePath, const TextureFiltering &text
 }
 
 void Texture2D::m_Unload() const {
-    if (tex != 0)
-        glDeleteTextures(1, &tex);
+    if (tex != 0 && m_OwnsTexture)
+        GLState::DeleteTexture(tex);
     if (m_VAO != 0)
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::DeleteVertexArray(m_VAO);
     if (m_VBO != 0)
-        glDeleteBuffers(1, &m_VBO);
+        GLState::DeleteBuffer(m_VBO);
+    if (m_EBO != 0)
+        GLState::DeleteBuffer(m_EBO);
 }
 
 void Texture2D::Draw(const Shader &shader) const {
+    // Keep the order with the batched DrawTex2D calls
+    Engine::FlushBatches();
+
     auto transform = glm::mat4(1.0f);
     const glm::vec2 center = {pos.x + (size.x / 2), pos.y + (size.y / 2)};
     transform = glm::translate(transform, glm::vec3(center, 0.0f));
@@ -109,11 +123,8 @@ void Texture2D::Draw(const Shader &shader) const {
     shader.SetVector3f("offset", glm::vec3(pos, 0.0f));
     shader.SetColor("inputColor", color);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glBindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, tex);
+    GLState::BindVertexArray(m_VAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 } // namespace CPL
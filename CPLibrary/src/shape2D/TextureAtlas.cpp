@@ -0,0 +1,221 @@
+#include "../../include/shape2D/TextureAtlas.h"
+#include "../../include/util/GLState.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stb_image.h>
+
+namespace CPL {
+TextureAtlas::TextureAtlas(const glm::ivec2 &pageSize, const int padding,
+                           const TextureFiltering &textureFiltering)
+    : m_PageSize(pageSize), m_Padding(std::max(0, padding)),
+      m_Filtering(textureFiltering) {}
+
+TextureAtlas::~TextureAtlas() {
+    // Handles reference the pages, delete them first
+    m_Textures.clear();
+    for (auto &page : m_Pages) {
+        if (page.tex != 0)
+            GLState::DeleteTexture(page.tex);
+    }
+}
+
+bool TextureAtlas::Add(const std::string &name, const std::string &filePath) {
+    stbi_set_flip_vertically_on_load(1);
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    uint8_t *data = stbi_load(filePath.c_str(), &width, &height, &channels, 4);
+    if (!static_cast<bool>(data)) {
+        Logging::Log(Logging::MessageStates::ERROR,
+                     "Failed to load atlas image: " + filePath);
+        return false;
+    }
+    PendingImage image{name, {width, height}, {}};
+    image.pixels.assign(data, data + (static_cast<size_t>(width) * height * 4));
+    stbi_image_free(data);
+    m_Pending.push_back(std::move(image));
+    return true;
+}
+
+bool TextureAtlas::AddPixels(const std::string &name, const uint8_t *pixels,
+                             const glm::ivec2 &size) {
+    if (!static_cast<bool>(pixels) || size.x <= 0 || size.y <= 0) {
+        Logging::Log(Logging::MessageStates::ERROR,
+                     "Invalid atlas image: " + name);
+        return false;
+    }
+    PendingImage image{name, size, {}};
+    const size_t rowBytes = static_cast<size_t>(size.x) * 4;
+    image.pixels.resize(rowBytes * size.y);
+    for (int y = 0; y < size.y; y++) {
+        std::memcpy(image.pixels.data() + (rowBytes * y),
+                    pixels + (rowBytes * (size.y - 1 - y)), rowBytes);
+    }
+    m_Pending.push_back(std::move(image));
+    return true;
+}
+
+void TextureAtlas::Build() {
+    // Tallest first packs the skyline a lot tighter
+    std::stable_sort(m_Pending.begin(), m_Pending.end(),
+                     [](const PendingImage &a, const PendingImage &b) {
+                         return a.size.y > b.size.y;
+                     });
+
+    for (const auto &image : m_Pending) {
+        const glm::ivec2 padded = image.size + glm::ivec2(m_Padding * 2);
+        if (padded.x > m_PageSize.x || padded.y > m_PageSize.y) {
+            Logging::Log(Logging::MessageStates::ERROR,
+                         "Atlas image larger than page: " + image.name);
+            continue;
+        }
+
+        glm::ivec2 pos{0};
+        size_t nodeIndex = 0;
+        size_t pageIndex = 0;
+        for (; pageIndex < m_Pages.size(); pageIndex++) {
+            if (m_FindPosition(m_Pages[pageIndex], padded, pos, nodeIndex))
+                break;
+        }
+        if (pageIndex == m_Pages.size()) {
+            Page page;
+            page.pixels.resize(static_cast<size_t>(m_PageSize.x) *
+                               m_PageSize.y * 4);
+            page.skyline.push_back({0, 0, m_PageSize.x});
+            m_Pages.push_back(std::move(page));
+            m_FindPosition(m_Pages.back(), padded, pos, nodeIndex);
+        }
+
+        Page &page = m_Pages[pageIndex];
+        m_InsertSkyline(page, nodeIndex, pos, padded);
+        const glm::ivec2 inner = pos + glm::ivec2(m_Padding);
+        m_CopyPadded(page, image, inner);
+        page.dirty = true;
+        // Texture is created on upload, handles get the id afterwards
+        const glm::vec4 uvRect = {
+            static_cast<float>(inner.x) / static_cast<float>(m_PageSize.x),
+            static_cast<float>(inner.y) / static_cast<float>(m_PageSize.y),
+            static_cast<float>(inner.x + image.size.x) /
+                static_cast<float>(m_PageSize.x),
+            static_cast<float>(inner.y + image.size.y) /
+                static_cast<float>(m_PageSize.y)};
+        if (page.tex == 0)
+            glGenTextures(1, &page.tex);
+        m_Textures.insert_or_assign(
+            image.name, Texture2D(page.tex, uvRect, glm::vec2(image.size)));
+    }
+    m_Pending.clear();
+
+    for (auto &page : m_Pages) {
+        if (page.dirty)
+            m_Upload(page);
+    }
+}
+
+Texture2D *TextureAtlas::Get(const std::string &name) {
+    const auto it = m_Textures.find(name);
+    return it == m_Textures.end() ? nullptr : &it->second;
+}
+
+uint32_t TextureAtlas::GetPageTexture(const size_t page) const {
+    return page < m_Pages.size() ? m_Pages[page].tex : 0;
+}
+
+bool TextureAtlas::m_FindPosition(const Page &page, const glm::ivec2 &size,
+                                  glm::ivec2 &pos, size_t &nodeIndex) const {
+    // Bottom left skyline: lowest resulting top edge, then narrowest node
+    int bestTop = INT_MAX;
+    int bestWidth = INT_MAX;
+    bool found = false;
+    for (size_t i = 0; i < page.skyline.size(); i++) {
+        const int x = page.skyline[i].x;
+        if (x + size.x > m_PageSize.x)
+            break;
+        int y = 0;
+        int widthLeft = size.x;
+        for (size_t j = i; widthLeft > 0; j++) {
+            y = std::max(y, page.skyline[j].y);
+            widthLeft -= page.skyline[j].width;
+        }
+        if (y + size.y > m_PageSize.y)
+            continue;
+        if (y + size.y < bestTop ||
+            (y + size.y == bestTop && page.skyline[i].width < bestWidth)) {
+            bestTop = y + size.y;
+            bestWidth = page.skyline[i].width;
+            pos = {x, y};
+            nodeIndex = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void TextureAtlas::m_InsertSkyline(Page &page, const size_t nodeIndex,
+                                   const glm::ivec2 &pos,
+                                   const glm::ivec2 &size) const {
+    auto &skyline = page.skyline;
+    skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(nodeIndex),
+                   {pos.x, pos.y + size.y, size.x});
+
+    // Cut the nodes now covered by the new one
+    for (size_t i = nodeIndex + 1; i < skyline.size();) {
+        const SkylineNode &prev = skyline[i - 1];
+        SkylineNode &node = skyline[i];
+        const int overlap = prev.x + prev.width - node.x;
+        if (overlap <= 0)
+            break;
+        node.x += overlap;
+        node.width -= overlap;
+        if (node.width > 0)
+            break;
+        skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // Merge neighbours with the same height
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i) +
+                          1);
+        } else {
+            i++;
+        }
+    }
+}
+
+void TextureAtlas::m_CopyPadded(Page &page, const PendingImage &image,
+                                const glm::ivec2 &pos) const {
+    // Every padding pixel repeats the nearest border pixel of the image
+    const int pad = m_Padding;
+    for (int y = -pad; y < image.size.y + pad; y++) {
+        const int srcY = std::clamp(y, 0, image.size.y - 1);
+        const uint8_t *srcRow =
+            image.pixels.data() + (static_cast<size_t>(srcY) * image.size.x * 4);
+        uint8_t *dstRow =
+            page.pixels.data() +
+            ((static_cast<size_t>(pos.y + y) * m_PageSize.x + pos.x) * 4);
+        for (int x = -pad; x < 0; x++)
+            std::memcpy(dstRow + (x * 4), srcRow, 4);
+        std::memcpy(dstRow, srcRow, static_cast<size_t>(image.size.x) * 4);
+        for (int x = image.size.x; x < image.size.x + pad; x++)
+            std::memcpy(dstRow + (x * 4),
+                        srcRow + (static_cast<size_t>(image.size.x - 1) * 4), 4);
+    }
+}
+
+void TextureAtlas::m_Upload(Page &page) const {
+    const GLint filter =
+        m_Filtering == TextureFiltering::LINEAR ? GL_LINEAR : GL_NEAREST;
+    GLState::BindTexture(0, GL_TEXTURE_2D, page.tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // No mip chain, lower levels would mix neighbouring images
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_PageSize.x, m_PageSize.y, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, page.pixels.data());
+    page.dirty = false;
+}
+} // namespace CPL
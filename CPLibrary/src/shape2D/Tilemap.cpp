@@ -1,101 +1,710 @@
 #include "../../include/shape2D/Tilemap.h"
 #include "../../include/Shader.h"
+#include "../../include/UniformBlocks.h"
 #include "../../include/shape2D/Texture2D.h"
+#include "../../include/util/GLState.h"
+#include "../../include/util/Logging.h"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
 
 namespace CPL {
-Tilemap::Tilemap() {
-    glGenVertexArrays(1, &m_VAO);
-    glBindVertexArray(m_VAO);
-    glBindVertexArray(0);
+namespace {
+constexpr int floatsPerVertex = 5;
+constexpr int floatsPerQuad = 6 * floatsPerVertex;
+
+constexpr std::array<char, 4> fileMagic = {'C', 'P', 'L', 'T'};
+// Bump if the file layout changes
+constexpr uint32_t fileVersion = 2;
+constexpr uint16_t collidableFlag = 1;
+} // namespace
+
+Tilemap::Tilemap(const float chunkSize) : m_ChunkSize(chunkSize) {}
+
+Tilemap::~Tilemap() { m_Clear(); }
+
+Tilemap::Tilemap(Tilemap &&other) noexcept
+    : tiles(std::move(other.tiles)), chunks(std::move(other.chunks)),
+      m_ChunkSize(other.m_ChunkSize), m_DrawnChunks(other.m_DrawnChunks),
+      m_Index(std::move(other.m_Index)), m_IndexCount(other.m_IndexCount),
+      m_Slots(std::move(other.m_Slots)),
+      m_Sizes(std::move(other.m_Sizes)), m_File(std::move(other.m_File)),
+      m_FileTextures(std::move(other.m_FileTextures)),
+      m_Streamed(std::move(other.m_Streamed)) {
+    other.chunks.clear();
+}
+
+Tilemap &Tilemap::operator=(Tilemap &&other) noexcept {
+    if (this != &other) {
+        m_Clear();
+        tiles = std::move(other.tiles);
+        chunks = std::move(other.chunks);
+        m_ChunkSize = other.m_ChunkSize;
+        m_DrawnChunks = other.m_DrawnChunks;
+        m_Index = std::move(other.m_Index);
+        m_IndexCount = other.m_IndexCount;
+        m_Slots = std::move(other.m_Slots);
+        m_Sizes = std::move(other.m_Sizes);
+        m_File = std::move(other.m_File);
+        m_FileTextures = std::move(other.m_FileTextures);
+        m_Streamed = std::move(other.m_Streamed);
+        other.chunks.clear();
+    }
+    return *this;
+}
+
+void Tilemap::m_DeleteChunk(Chunk &chunk) {
+    if (chunk.VAO != 0 && glIsVertexArray(chunk.VAO))
+        GLState::DeleteVertexArray(chunk.VAO);
+    if (chunk.VBO != 0 && glIsBuffer(chunk.VBO))
+        GLState::DeleteBuffer(chunk.VBO);
+    chunk.VAO = 0;
+    chunk.VBO = 0;
+}
+
+void Tilemap::m_Clear() {
+    for (auto &[key, chunk] : chunks)
+        m_DeleteChunk(chunk);
+    chunks.clear();
+    tiles.clear();
+    m_Index.clear();
+    m_IndexCount = 0;
+    m_Slots.clear();
+    m_Sizes.clear();
+    m_File = MappedFile();
+    m_FileTextures.clear();
+    m_Streamed.clear();
+}
+
+void Tilemap::BeginEditing() {
+    for (auto &[key, chunk] : chunks)
+        m_DeleteChunk(chunk);
+    chunks.clear();
+    for (Slot &slot : m_Slots)
+        slot.quad = noQuad;
+}
+
+size_t Tilemap::TileKeyHash::operator()(const TileKey &key) const {
+    // Tiles of one map nearly always share the size, so mix the cell well
+    const uint64_t cell =
+        (static_cast<uint64_t>(static_cast<uint32_t>(key.cell.x)) << 32) |
+        static_cast<uint32_t>(key.cell.y);
+    // Bits of the size instead of std::hash<float>, which hashes bytes out
+    // of line. + 0 turns -0 into 0, they compare equal
+    uint32_t sizeX = 0;
+    uint32_t sizeY = 0;
+    const float x = key.size.x + 0.0f;
+    const float y = key.size.y + 0.0f;
+    std::memcpy(&sizeX, &x, sizeof(sizeX));
+    std::memcpy(&sizeY, &y, sizeof(sizeY));
+    uint64_t hash = (cell ^ (static_cast<uint64_t>(sizeX) << 32 | sizeY)) *
+                    0x9E3779B97F4A7C15ull;
+    hash ^= static_cast<uint64_t>(sizeX) * 0xC2B2AE3D27D4EB4Full;
+    return static_cast<size_t>(hash ^ (hash >> 32));
 }
 
-void Tilemap::BeginEditing() { batches.clear(); }
+Tilemap::TileKey Tilemap::m_Key(const glm::vec2 &pos, const glm::vec2 &size) {
+    return {glm::ivec2(static_cast<int>(std::lround(pos.x / size.x)),
+                       static_cast<int>(std::lround(pos.y / size.y))),
+            size};
+}
+
+uint64_t Tilemap::m_ChunkKey(const glm::vec2 &pos) const {
+    const auto x = static_cast<int32_t>(std::floor(pos.x / m_ChunkSize));
+    const auto y = static_cast<int32_t>(std::floor(pos.y / m_ChunkSize));
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+           static_cast<uint32_t>(y);
+}
 
 void Tilemap::AddTile(const glm::vec2 &pos, const glm::vec2 &size,
                       const Texture2D *const tex) {
+    m_AddTile(pos, size, tex);
+}
+
+uint32_t Tilemap::m_AddTile(const glm::vec2 &pos, const glm::vec2 &size,
+                            const Texture2D *const tex) {
     if (!static_cast<bool>(tex) || tex->tex == 0)
+        return noTile;
+    const TileKey key = m_Key(pos, size);
+
+    // Other tiles stack on the cell, the same tile is only there once
+    uint32_t last = noTile;
+    for (uint32_t i = m_FirstAt(key.cell, size); i != noTile;
+         i = m_Slots[i].next) {
+        const Tile &tile = tiles[i];
+        if (tile.pos == pos && tile.texture == tex->tex &&
+            tile.uvRect == tex->uvRect) {
+            if (m_Slots[i].quad == noQuad)
+                m_AddQuad(i);
+            return i;
+        }
+        last = i;
+    }
+
+    const auto index = static_cast<uint32_t>(tiles.size());
+    Tile &tile = tiles.emplace_back(pos, size);
+    tile.texture = tex->tex;
+    tile.uvRect = tex->uvRect;
+    m_Slots.push_back({0, noQuad, noTile});
+    // Appended so the order of a cell is the order tiles were added in
+    if (last == noTile)
+        m_InsertIndex(key, index);
+    else
+        m_Slots[last].next = index;
+    m_CountSize(tile, 1);
+    m_AddQuad(index);
+    return index;
+}
+
+void Tilemap::m_AddQuad(const uint32_t index) {
+    const Tile &tile = tiles[index];
+    const glm::vec2 &pos = tile.pos;
+    const glm::vec2 &size = tile.size;
+    // uvRect is only a part of the texture for TextureAtlas handles
+    const glm::vec4 &uv = tile.uvRect;
+    const std::array<float, floatsPerQuad> quad = {
+        pos.x,          pos.y,          0, uv.x, uv.w,
+        pos.x + size.x, pos.y,          0, uv.z, uv.w,
+        pos.x + size.x, pos.y + size.y, 0, uv.z, uv.y,
+
+        pos.x,          pos.y,          0, uv.x, uv.w,
+        pos.x + size.x, pos.y + size.y, 0, uv.z, uv.y,
+        pos.x,          pos.y + size.y, 0, uv.x, uv.y};
+
+    const uint64_t chunkKey = m_ChunkKey(pos);
+    const auto [it, created] = chunks.try_emplace(chunkKey);
+    Chunk &chunk = it->second;
+    if (created) {
+        chunk.min = pos;
+        chunk.max = pos + size;
+    } else {
+        chunk.min = glm::min(chunk.min, pos);
+        chunk.max = glm::max(chunk.max, pos + size);
+    }
+    TileBatch &batch = chunk.batches[tile.texture];
+    batch.vertices.insert(batch.vertices.end(), std::begin(quad),
+                          std::end(quad));
+    batch.owners.push_back(index);
+    chunk.dirty = true;
+
+    m_Slots[index].chunk = chunkKey;
+    m_Slots[index].quad = static_cast<uint32_t>(batch.owners.size() - 1);
+}
+
+void Tilemap::m_CountSize(const Tile &tile, const int change) {
+    const auto it = std::find_if(
+        m_Sizes.begin(), m_Sizes.end(),
+        [&](const SizeCount &entry) { return entry.size == tile.size; });
+    const uint32_t offGrid =
+        tile.pos != glm::vec2(m_Key(tile.pos, tile.size).cell) * tile.size
+            ? 1
+            : 0;
+    if (it == m_Sizes.end()) {
+        if (change > 0)
+            m_Sizes.push_back({tile.size, static_cast<uint32_t>(change),
+                               offGrid * static_cast<uint32_t>(change)});
         return;
-    const std::array<float, 30> quad = {
-        pos.x,          pos.y,          0, 0, 1,
-        pos.x + size.x, pos.y,          0, 1, 1,
-        pos.x + size.x, pos.y + size.y, 0, 1, 0,
+    }
+    it->count = static_cast<uint32_t>(static_cast<int>(it->count) + change);
+    it->offGrid = static_cast<uint32_t>(static_cast<int>(it->offGrid) +
+                                        static_cast<int>(offGrid) * change);
+    if (it->count == 0)
+        m_Sizes.erase(it);
+}
 
-        pos.x,          pos.y,          0, 0, 1,
-        pos.x + size.x, pos.y + size.y, 0, 1, 0,
-        pos.x,          pos.y + size.y, 0, 0, 0};
+void Tilemap::m_RemoveQuad(const uint32_t index) {
+    // Move the last quad of the batch into the hole
+    const Slot slot = m_Slots[index];
+    const auto chunkIt = chunks.find(slot.chunk);
+    Chunk &chunk = chunkIt->second;
+    const auto batchIt = chunk.batches.find(tiles[index].texture);
+    TileBatch &batch = batchIt->second;
 
-    auto &[vertices, VBO] = batches[tex->tex];
-    vertices.insert(vertices.end(), std::begin(quad), std::end(quad));
-    tiles.emplace_back(pos, size);
-    if (VBO == 0)
-        glGenBuffers(1, &VBO);
+    const auto lastQuad = static_cast<uint32_t>(batch.owners.size() - 1);
+    if (slot.quad != lastQuad) {
+        std::copy_n(batch.vertices.begin() + lastQuad * floatsPerQuad,
+                    floatsPerQuad,
+                    batch.vertices.begin() + slot.quad * floatsPerQuad);
+        batch.owners[slot.quad] = batch.owners[lastQuad];
+        m_Slots[batch.owners[slot.quad]].quad = slot.quad;
+    }
+    batch.vertices.resize(batch.vertices.size() - floatsPerQuad);
+    batch.owners.pop_back();
+    chunk.dirty = true;
+    if (batch.owners.empty())
+        chunk.batches.erase(batchIt);
+    if (chunk.batches.empty()) {
+        m_DeleteChunk(chunk);
+        chunks.erase(chunkIt);
+    }
+    m_Slots[index].quad = noQuad;
+}
+
+uint32_t &Tilemap::m_LinkTo(const uint32_t index) {
+    uint32_t *link =
+        &m_Index[m_IndexSlot(m_Key(tiles[index].pos, tiles[index].size))]
+             .tile;
+    while (*link != index)
+        link = &m_Slots[*link].next;
+    return *link;
+}
+
+void Tilemap::m_RemoveTile(const uint32_t index) {
+    if (m_Slots[index].quad != noQuad)
+        m_RemoveQuad(index);
+    m_CountSize(tiles[index], -1);
+
+    // Take the tile out of its cell
+    const TileKey key = m_Key(tiles[index].pos, tiles[index].size);
+    if (const size_t slot = m_IndexSlot(key);
+        m_Index[slot].tile == index && m_Slots[index].next == noTile)
+        m_EraseIndex(slot);
+    else
+        m_LinkTo(index) = m_Slots[index].next;
+
+    // Move the last tile into the hole
+    const auto lastTile = static_cast<uint32_t>(tiles.size() - 1);
+    if (index != lastTile) {
+        m_LinkTo(lastTile) = index;
+        tiles[index] = tiles[lastTile];
+        m_Slots[index] = m_Slots[lastTile];
+        if (m_Slots[index].quad != noQuad)
+            chunks[m_Slots[index].chunk]
+                .batches[tiles[index].texture]
+                .owners[m_Slots[index].quad] = index;
+    }
+    tiles.pop_back();
+    m_Slots.pop_back();
 }
 
 void Tilemap::DeleteTile(const glm::vec2 &pos, const glm::vec2 &size,
                          const Texture2D *const tex) {
     if (!static_cast<bool>(tex) || tex->tex == 0)
         return;
-    tiles.erase(std::remove_if(tiles.begin(), tiles.end(),
-                               [&](const Tile &tile) {
-                                   return tile.pos == pos && tile.size == size;
-                               }),
-                tiles.end());
-
-    auto it = batches.find(tex->tex);
-    if (it == batches.end())
-        return;
-    auto &[vertices, VBO] = it->second;
+    // Only the tile of this texture, tiles stacked on it stay
+    for (uint32_t i = m_FirstAt(m_Key(pos, size).cell, size); i != noTile;
+         i = m_Slots[i].next) {
+        const Tile &tile = tiles[i];
+        if (tile.pos == pos && tile.texture == tex->tex &&
+            tile.uvRect == tex->uvRect) {
+            m_RemoveTile(i);
+            return;
+        }
+    }
+}
+
+int Tilemap::FindTile(const glm::vec2 &pos, const glm::vec2 &size) const {
+    for (uint32_t i = m_FirstAt(m_Key(pos, size).cell, size); i != noTile;
+         i = m_Slots[i].next) {
+        if (tiles[i].pos == pos)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
 
-    const int floatsPerQuad = 30;
+bool Tilemap::TileExist(const glm::vec2 &pos, const glm::vec2 &size) const {
+    return FindTile(pos, size) >= 0;
+}
 
-    for (int i = 0; i < vertices.size(); i += floatsPerQuad) {
-        if (i + 1 < vertices.size()) {
-            const float quadX = vertices[i];
-            const float quadY = vertices[i + 1];
+void Tilemap::CheckCollidableTiles(const glm::vec2 &size) {
+    const std::array<glm::ivec2, 4> neighbors = {
+        glm::ivec2(-1, 0), glm::ivec2(1, 0), glm::ivec2(0, -1),
+        glm::ivec2(0, 1)};
 
-            if (std::abs(quadX - pos.x) < 0.01f &&
-                std::abs(quadY - pos.y) < 0.01f) {
-                vertices.erase(vertices.begin() + i,
-                               vertices.begin() + i + floatsPerQuad);
+    for (auto &tile : tiles) {
+        const TileKey key = m_Key(tile.pos, size);
+        bool exposed = false;
+        for (const glm::ivec2 &offset : neighbors) {
+            if (m_FirstAt(key.cell + offset, size) == noTile) {
+                exposed = true;
                 break;
             }
         }
+        tile.isCollidable = exposed;
     }
-    if (vertices.empty()) {
-        if (VBO != 0) {
-            glDeleteBuffers(1, &VBO);
+}
+
+uint32_t Tilemap::m_FirstAt(const glm::ivec2 &cell,
+                            const glm::vec2 &size) const {
+    if (m_Index.empty())
+        return noTile;
+    return m_Index[m_IndexSlot({cell, size})].tile;
+}
+
+size_t Tilemap::m_IndexSlot(const TileKey &key) const {
+    const size_t mask = m_Index.size() - 1;
+    size_t slot = TileKeyHash{}(key) & mask;
+    while (m_Index[slot].tile != noTile && !(m_Index[slot].key == key))
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void Tilemap::m_ReserveIndex(const size_t count) {
+    size_t size = 16;
+    while (size < count * 2)
+        size *= 2;
+    if (size <= m_Index.size())
+        return;
+    std::vector<IndexEntry> old(size);
+    old.swap(m_Index);
+    for (const IndexEntry &entry : old) {
+        if (entry.tile != noTile)
+            m_Index[m_IndexSlot(entry.key)] = entry;
+    }
+}
+
+void Tilemap::m_InsertIndex(const TileKey &key, const uint32_t tile) {
+    m_ReserveIndex(m_IndexCount + 1);
+    m_Index[m_IndexSlot(key)] = {key, tile};
+    m_IndexCount++;
+}
+
+void Tilemap::m_EraseIndex(size_t slot) {
+    // Move later entries of the probe sequence back into the hole, so
+    // lookups don't need tombstones
+    const size_t mask = m_Index.size() - 1;
+    for (size_t i = (slot + 1) & mask; m_Index[i].tile != noTile;
+         i = (i + 1) & mask) {
+        const size_t home = TileKeyHash{}(m_Index[i].key) & mask;
+        if (((i - home) & mask) >= ((i - slot) & mask)) {
+            m_Index[slot] = m_Index[i];
+            slot = i;
         }
-        batches.erase(it);
     }
+    m_Index[slot].tile = noTile;
+    m_IndexCount--;
 }
 
-bool Tilemap::TileExist(const glm::vec2 &pos, const glm::vec2 &size) {
-    Tile tile(pos, size);
-    auto it = std::find(tiles.begin(), tiles.end(), tile);
-    return it != tiles.end();
+int Tilemap::TileAt(const glm::vec2 &point) const {
+    for (const SizeCount &entry : m_Sizes) {
+        const glm::vec2 scaled = point / entry.size;
+        if (entry.offGrid == 0) {
+            const uint32_t index =
+                m_FirstAt(glm::ivec2(glm::floor(scaled)), entry.size);
+            if (index != noTile)
+                return static_cast<int>(index);
+            continue;
+        }
+        // Cells of the tiles that can cover the point, see QueryRect
+        const glm::ivec2 first(glm::ceil(scaled - 1.5f));
+        const glm::ivec2 last(glm::floor(scaled + 0.5f));
+        for (int y = first.y; y <= last.y; y++) {
+            for (int x = first.x; x <= last.x; x++) {
+                for (uint32_t i = m_FirstAt({x, y}, entry.size); i != noTile;
+                     i = m_Slots[i].next) {
+                    const Tile &tile = tiles[i];
+                    if (point.x >= tile.pos.x &&
+                        point.x <= tile.pos.x + tile.size.x &&
+                        point.y >= tile.pos.y &&
+                        point.y <= tile.pos.y + tile.size.y)
+                        return static_cast<int>(i);
+                }
+            }
+        }
+    }
+    return -1;
 }
 
-void Tilemap::CheckCollidableTiles(const glm::vec2 &size) {
-    for (auto &tile : tiles) {
-        glm::vec2 p = tile.pos / size;
-        bool exposed = false;
+void Tilemap::QueryRect(const glm::vec2 &pos, const glm::vec2 &size,
+                        std::vector<uint32_t> &result) const {
+    result.clear();
+    const glm::vec2 max = pos + size;
+    const auto overlaps = [&](const Tile &tile) {
+        // Same as CheckCollisionRects
+        return tile.isCollidable && tile.pos.x <= max.x &&
+               tile.pos.x + tile.size.x >= pos.x && tile.pos.y <= max.y &&
+               tile.pos.y + tile.size.y >= pos.y;
+    };
 
-        std::array<glm::vec2, 4> neighbors = {
-            glm::vec2(p.x - 1, p.y), glm::vec2(p.x + 1, p.y),
-            glm::vec2(p.x, p.y - 1), glm::vec2(p.x, p.y + 1)};
+    for (const SizeCount &entry : m_Sizes) {
+        // Cells whose tile can reach into the rect, the tile position is
+        // rounded to the nearest cell
+        const glm::vec2 first = glm::ceil(pos / entry.size - 1.5f);
+        const glm::vec2 last = glm::floor(max / entry.size + 0.5f);
+        const glm::vec2 cells = last - first + 1.0f;
+        if (cells.x <= 0 || cells.y <= 0)
+            continue;
 
-        for (auto &n : neighbors) {
-            if (!TileExist(n * size, size)) {
-                exposed = true;
-                break;
+        // Checking every tile is cheaper for rects bigger than the map
+        if (cells.x * cells.y > static_cast<float>(entry.count)) {
+            for (size_t i = 0; i < tiles.size(); i++) {
+                if (tiles[i].size == entry.size && overlaps(tiles[i]))
+                    result.push_back(static_cast<uint32_t>(i));
             }
+            continue;
+        }
+        for (int y = static_cast<int>(first.y); y <= static_cast<int>(last.y);
+             y++) {
+            for (int x = static_cast<int>(first.x);
+                 x <= static_cast<int>(last.x); x++) {
+                for (uint32_t i = m_FirstAt({x, y}, entry.size); i != noTile;
+                     i = m_Slots[i].next) {
+                    if (overlaps(tiles[i]))
+                        result.push_back(i);
+                }
+            }
+        }
+    }
+}
+
+void Tilemap::QueryCircle(const glm::vec2 &center, const float radius,
+                          std::vector<uint32_t> &result) const {
+    QueryRect(center - radius, glm::vec2(radius * 2.0f), result);
+    // Same as CheckCollisionCircleRect
+    const auto outside = [&](const uint32_t index) {
+        const Tile &tile = tiles[index];
+        const glm::vec2 closest =
+            glm::clamp(center, tile.pos, tile.pos + tile.size);
+        const glm::vec2 delta = closest - center;
+        return glm::dot(delta, delta) > radius * radius;
+    };
+    result.erase(std::remove_if(result.begin(), result.end(), outside),
+                 result.end());
+}
+
+namespace {
+// Visits the grid cells the segment passes through in order (Amanatides &
+// Woo). visit(cell, t, normal) with t in [0, 1] where the segment enters the
+// cell, returns true to stop
+template <typename Visit>
+void TraverseGrid(const glm::vec2 &start, const glm::vec2 &end,
+                  const glm::vec2 &size, Visit &&visit) {
+    const glm::vec2 delta = end - start;
+    glm::ivec2 cell(glm::floor(start / size));
+    const glm::ivec2 last(glm::floor(end / size));
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    glm::ivec2 step(0);
+    glm::vec2 tMax(infinity);
+    glm::vec2 tDelta(infinity);
+    for (int axis = 0; axis < 2; axis++) {
+        if (delta[axis] > 0) {
+            step[axis] = 1;
+            tMax[axis] = (static_cast<float>(cell[axis] + 1) * size[axis] -
+                          start[axis]) /
+                         delta[axis];
+        } else if (delta[axis] < 0) {
+            step[axis] = -1;
+            tMax[axis] =
+                (static_cast<float>(cell[axis]) * size[axis] - start[axis]) /
+                delta[axis];
+        } else {
+            continue;
+        }
+        tDelta[axis] = size[axis] / std::abs(delta[axis]);
+    }
+
+    if (visit(cell, 0.0f, glm::vec2(0.0f)))
+        return;
+    // The step count is known up front, so float error can't overshoot
+    const int steps = std::abs(last.x - cell.x) + std::abs(last.y - cell.y);
+    for (int i = 0; i < steps; i++) {
+        const int axis = tMax.x < tMax.y ? 0 : 1;
+        cell[axis] += step[axis];
+        const float t = std::min(tMax[axis], 1.0f);
+        tMax[axis] += tDelta[axis];
+        glm::vec2 normal(0.0f);
+        normal[axis] = static_cast<float>(-step[axis]);
+        if (visit(cell, t, normal))
+            return;
+    }
+}
+
+// Where the segment start + delta * t enters the box, false if it misses it
+bool SegmentEntersBox(const glm::vec2 &start, const glm::vec2 &delta,
+                      const glm::vec2 &min, const glm::vec2 &max, float &t,
+                      glm::vec2 &normal) {
+    float enter = 0.0f;
+    float leave = 1.0f;
+    normal = glm::vec2(0.0f);
+    for (int axis = 0; axis < 2; axis++) {
+        if (delta[axis] == 0) {
+            if (start[axis] < min[axis] || start[axis] > max[axis])
+                return false;
+            continue;
+        }
+        float t0 = (min[axis] - start[axis]) / delta[axis];
+        float t1 = (max[axis] - start[axis]) / delta[axis];
+        float side = -1.0f;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+            side = 1.0f;
+        }
+        if (t0 > enter) {
+            enter = t0;
+            normal = glm::vec2(0.0f);
+            normal[axis] = side;
+        }
+        leave = std::min(leave, t1);
+        if (enter > leave)
+            return false;
+    }
+    t = enter;
+    return true;
+}
+} // namespace
+
+void Tilemap::QuerySegment(const glm::vec2 &start, const glm::vec2 &end,
+                           std::vector<uint32_t> &result) const {
+    result.clear();
+    if (m_Visited.size() < tiles.size())
+        m_Visited.resize(tiles.size(), 0);
+    if (++m_VisitStamp == 0) {
+        // Wrapped around, old stamps could match again
+        std::fill(m_Visited.begin(), m_Visited.end(), 0);
+        m_VisitStamp = 1;
+    }
+    for (const SizeCount &entry : m_Sizes) {
+        TraverseGrid(
+            start, end, entry.size,
+            [&](const glm::ivec2 &cell, float, const glm::vec2 &) {
+                if (entry.offGrid == 0) {
+                    for (uint32_t i = m_FirstAt(cell, entry.size);
+                         i != noTile; i = m_Slots[i].next) {
+                        if (tiles[i].isCollidable)
+                            result.push_back(i);
+                    }
+                    return false;
+                }
+                // Off grid tiles of the neighbour cells can reach into
+                // this one
+                float t = 0;
+                glm::vec2 normal(0.0f);
+                for (int y = cell.y - 1; y <= cell.y + 1; y++) {
+                    for (int x = cell.x - 1; x <= cell.x + 1; x++) {
+                        for (uint32_t i = m_FirstAt({x, y}, entry.size);
+                             i != noTile; i = m_Slots[i].next) {
+                            if (m_Visited[i] == m_VisitStamp)
+                                continue;
+                            m_Visited[i] = m_VisitStamp;
+                            const Tile &tile = tiles[i];
+                            if (tile.isCollidable &&
+                                SegmentEntersBox(start, end - start,
+                                                 tile.pos,
+                                                 tile.pos + tile.size, t,
+                                                 normal))
+                                result.push_back(i);
+                        }
+                    }
+                }
+                return false;
+            });
+    }
+}
+
+Tilemap::RaycastHit Tilemap::Raycast(const glm::vec2 &start,
+                                     const glm::vec2 &end) const {
+    RaycastHit hit;
+    float nearest = std::numeric_limits<float>::infinity();
+    for (const SizeCount &entry : m_Sizes) {
+        TraverseGrid(
+            start, end, entry.size,
+            [&](const glm::ivec2 &cell, const float t,
+                const glm::vec2 &normal) {
+                // Cells further than a hit of another size
+                if (t >= nearest)
+                    return true;
+                if (entry.offGrid == 0) {
+                    for (uint32_t i = m_FirstAt(cell, entry.size);
+                         i != noTile; i = m_Slots[i].next) {
+                        if (!tiles[i].isCollidable)
+                            continue;
+                        nearest = t;
+                        hit.tile = static_cast<int>(i);
+                        hit.normal = normal;
+                        return true;
+                    }
+                    return false;
+                }
+                // Off grid tiles of the neighbour cells can reach into
+                // this one, the nearest of them is hit
+                float tileT = 0;
+                glm::vec2 tileNormal(0.0f);
+                for (int y = cell.y - 1; y <= cell.y + 1; y++) {
+                    for (int x = cell.x - 1; x <= cell.x + 1; x++) {
+                        for (uint32_t i = m_FirstAt({x, y}, entry.size);
+                             i != noTile; i = m_Slots[i].next) {
+                            const Tile &tile = tiles[i];
+                            if (!tile.isCollidable ||
+                                !SegmentEntersBox(start, end - start,
+                                                  tile.pos,
+                                                  tile.pos + tile.size, tileT,
+                                                  tileNormal) ||
+                                tileT >= nearest)
+                                continue;
+                            nearest = tileT;
+                            hit.tile = static_cast<int>(i);
+                            hit.normal = tileNormal;
+                        }
+                    }
+                }
+                return false;
+            });
+    }
+    if (hit.tile >= 0) {
+        hit.point = start + (end - start) * nearest;
+        hit.distance = glm::length(end - start) * nearest;
+    }
+    return hit;
+}
+
+void Tilemap::m_Upload(Chunk &chunk) {
+    size_t total = 0;
+    for (const auto &[texture, batch] : chunk.batches)
+        total += batch.vertices.size();
+
+    if (chunk.VAO == 0) {
+        glGenVertexArrays(1, &chunk.VAO);
+        glGenBuffers(1, &chunk.VBO);
+        // The layout never changes, so it is only set once per chunk
+        GLState::BindVertexArray(chunk.VAO);
+        GLState::BindArrayBuffer(chunk.VBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+                              floatsPerVertex * sizeof(float),
+                              static_cast<void *>(nullptr));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE,
+                              floatsPerVertex * sizeof(float),
+                              reinterpret_cast<void *>(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    }
+    GLState::BindArrayBuffer(chunk.VBO);
+    if (total > chunk.capacity) {
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(total * sizeof(float)), nullptr,
+                     GL_STATIC_DRAW);
+        chunk.capacity = total;
+    }
+
+    // Every texture is one run in the buffer. Bounds are recomputed here,
+    // deleted tiles can shrink them
+    size_t offset = 0;
+    bool first = true;
+    for (auto &[texture, batch] : chunk.batches) {
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(offset * sizeof(float)),
+                        static_cast<GLsizeiptr>(batch.vertices.size() *
+                                                sizeof(float)),
+                        batch.vertices.data());
+        batch.first = static_cast<uint32_t>(offset / floatsPerVertex);
+        offset += batch.vertices.size();
+
+        for (size_t i = 0; i < batch.vertices.size(); i += floatsPerVertex) {
+            const glm::vec2 vertex(batch.vertices[i], batch.vertices[i + 1]);
+            chunk.min = first ? vertex : glm::min(chunk.min, vertex);
+            chunk.max = first ? vertex : glm::max(chunk.max, vertex);
+            first = false;
         }
-        tile.isCollidable = exposed;
     }
+    chunk.dirty = false;
 }
 
 void Tilemap::Draw() {
+    Engine::FlushBatches();
+
     constexpr auto transform = glm::mat4(1.0f);
 
     if (GetCurMode() == DrawModes::TEX_LIGHT) {
@@ -110,30 +719,242 @@ void Tilemap::Draw() {
         GetShader(DrawModes::TEX).SetColor("inputColor", WHITE);
     }
 
-    glBindVertexArray(m_VAO);
+    // World rectangle seen by the camera of the current BeginDraw
+    const glm::mat4 inverse =
+        glm::inverse(UniformBlocks::GetCamera().projection);
+    glm::vec2 viewMin(0.0f);
+    glm::vec2 viewMax(0.0f);
+    for (int i = 0; i < 4; i++) {
+        const glm::vec4 corner =
+            inverse * glm::vec4(i % 2 == 0 ? -1.0f : 1.0f,
+                                i < 2 ? -1.0f : 1.0f, 0.0f, 1.0f);
+        const glm::vec2 world(corner.x, corner.y);
+        viewMin = i == 0 ? world : glm::min(viewMin, world);
+        viewMax = i == 0 ? world : glm::max(viewMax, world);
+    }
 
-    for (auto &[id, batch] : batches) {
-        glBindBuffer(GL_ARRAY_BUFFER, batch.VBO);
-        glBufferData(
-            GL_ARRAY_BUFFER,
-            static_cast<GLsizeiptr>(batch.vertices.size() * sizeof(float)),
-            batch.vertices.data(), GL_DYNAMIC_DRAW);
+    m_DrawnChunks = 0;
+    for (auto &[key, chunk] : chunks) {
+        if (chunk.max.x < viewMin.x || chunk.min.x > viewMax.x ||
+            chunk.max.y < viewMin.y || chunk.min.y > viewMax.y)
+            continue;
+        if (chunk.dirty)
+            m_Upload(chunk);
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-                              static_cast<void *>(nullptr));
-        glEnableVertexAttribArray(0);
+        GLState::BindVertexArray(chunk.VAO);
+        for (const auto &[texture, batch] : chunk.batches) {
+            GLState::BindTexture(0, GL_TEXTURE_2D, texture);
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(batch.first),
+                         static_cast<GLsizei>(batch.vertices.size() /
+                                              floatsPerVertex));
+        }
+        m_DrawnChunks++;
+    }
+}
 
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-                              reinterpret_cast<void *>(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+bool Tilemap::Save(const std::string &filePath,
+                   const std::vector<const Texture2D *> &textures) const {
+    static_assert(sizeof(FileHeader) == 24 && sizeof(FileChunk) == 32 &&
+                  sizeof(FileTile) == 20);
+
+    // Tiles per chunk, not from chunks so tiles BeginEditing removed from
+    // drawing are saved too
+    std::map<uint64_t, std::vector<uint32_t>> grouped;
+    for (size_t i = 0; i < tiles.size(); i++)
+        grouped[m_ChunkKey(tiles[i].pos)].push_back(static_cast<uint32_t>(i));
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, id);
-        glDrawArrays(GL_TRIANGLES, 0,
-                     static_cast<GLsizei>(batch.vertices.size() / 5));
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+    std::vector<FileChunk> entries;
+    std::vector<FileTile> records;
+    entries.reserve(grouped.size());
+    records.reserve(tiles.size());
+
+    for (const auto &[key, indices] : grouped) {
+        FileChunk entry{};
+        entry.chunk = {static_cast<int32_t>(key >> 32),
+                       static_cast<int32_t>(key & 0xFFFFFFFFu)};
+        entry.min = tiles[indices[0]].pos;
+        entry.max = tiles[indices[0]].pos + tiles[indices[0]].size;
+        entry.firstTile = static_cast<uint32_t>(records.size());
+
+        for (const uint32_t index : indices) {
+            const Tile &tile = tiles[index];
+            // Atlas handles share the texture, so compare the UVs too
+            const auto it = std::find_if(
+                textures.begin(), textures.end(), [&](const Texture2D *tex) {
+                    return tex != nullptr && tex->tex == tile.texture &&
+                           tex->uvRect == tile.uvRect;
+                });
+            if (it == textures.end()) {
+                Logging::Log(Logging::MessageStates::ERROR,
+                             "Tilemap uses a texture that is not in the "
+                             "texture list, not saved: " +
+                                 filePath);
+                return false;
+            }
+            entry.min = glm::min(entry.min, tile.pos);
+            entry.max = glm::max(entry.max, tile.pos + tile.size);
+
+            FileTile record{};
+            record.pos = tile.pos;
+            record.size = tile.size;
+            record.texture = static_cast<uint16_t>(it - textures.begin());
+            record.flags = tile.isCollidable ? collidableFlag : 0;
+            records.push_back(record);
+        }
+        entry.tileCount =
+            static_cast<uint32_t>(records.size()) - entry.firstTile;
+        entries.push_back(entry);
     }
-    glBindVertexArray(0);
+
+    const FileHeader header{fileMagic,
+                            fileVersion,
+                            m_ChunkSize,
+                            static_cast<uint32_t>(textures.size()),
+                            static_cast<uint32_t>(entries.size()),
+                            static_cast<uint32_t>(records.size())};
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        Logging::Log(Logging::MessageStates::ERROR,
+                     "Could not write " + filePath);
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader));
+    file.write(reinterpret_cast<const char *>(entries.data()),
+               static_cast<std::streamsize>(entries.size() *
+                                            sizeof(FileChunk)));
+    file.write(reinterpret_cast<const char *>(records.data()),
+               static_cast<std::streamsize>(records.size() *
+                                            sizeof(FileTile)));
+    return static_cast<bool>(file);
+}
+
+bool Tilemap::Open(const std::string &filePath,
+                   const std::vector<const Texture2D *> &textures) {
+    m_Clear();
+    MappedFile file(filePath);
+    if (!file.IsOpen())
+        return false;
+
+    FileHeader header{};
+    bool valid = file.GetSize() >= sizeof(FileHeader);
+    if (valid) {
+        std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+        valid = header.magic == fileMagic && header.version == fileVersion &&
+                header.chunkSize > 0 &&
+                file.GetSize() >=
+                    sizeof(FileHeader) +
+                        static_cast<size_t>(header.chunkCount) *
+                            sizeof(FileChunk) +
+                        static_cast<size_t>(header.tileCount) *
+                            sizeof(FileTile);
+    }
+    if (!valid) {
+        Logging::Log(Logging::MessageStates::ERROR,
+                     "Not a tilemap file or a different version: " +
+                         filePath);
+        return false;
+    }
+    if (textures.size() < header.textureCount) {
+        Logging::Log(Logging::MessageStates::WARNING,
+                     "Tilemap " + filePath + " uses " +
+                         std::to_string(header.textureCount) +
+                         " textures, tiles of missing ones are skipped");
+    }
+
+    m_ChunkSize = header.chunkSize;
+    m_File = std::move(file);
+    m_FileTextures = textures;
+    m_Streamed.assign(header.chunkCount, false);
+    // Everything is allocated once up front instead of per tile
+    tiles.reserve(header.tileCount);
+    m_Slots.reserve(header.tileCount);
+    m_ReserveIndex(header.tileCount);
+    return true;
+}
+
+uint32_t Tilemap::StreamChunks(const glm::vec2 &min, const glm::vec2 &max) {
+    if (!m_File.IsOpen())
+        return 0;
+
+    const uint8_t *entries = m_File.GetData() + sizeof(FileHeader);
+    // Tiles per texture of a chunk, reused for every chunk
+    std::vector<uint32_t> counts(m_FileTextures.size());
+    uint32_t added = 0;
+    for (size_t i = 0; i < m_Streamed.size(); i++) {
+        if (m_Streamed[i])
+            continue;
+        FileChunk entry{};
+        std::memcpy(&entry, entries + i * sizeof(FileChunk),
+                    sizeof(FileChunk));
+        if (entry.max.x < min.x || entry.min.x > max.x ||
+            entry.max.y < min.y || entry.min.y > max.y)
+            continue;
+        m_StreamChunk(entry, counts);
+        m_Streamed[i] = true;
+        added++;
+    }
+    return added;
+}
+
+void Tilemap::m_StreamChunk(const FileChunk &entry,
+                            std::vector<uint32_t> &counts) {
+    FileHeader header{};
+    std::memcpy(&header, m_File.GetData(), sizeof(FileHeader));
+    if (static_cast<uint64_t>(entry.firstTile) + entry.tileCount >
+        header.tileCount)
+        return;
+    const uint8_t *records =
+        m_File.GetData() + sizeof(FileHeader) +
+        static_cast<size_t>(header.chunkCount) * sizeof(FileChunk) +
+        static_cast<size_t>(entry.firstTile) * sizeof(FileTile);
+
+    // Size the batches of the chunk once before adding its tiles
+    std::fill(counts.begin(), counts.end(), 0);
+    FileTile record{};
+    for (uint32_t i = 0; i < entry.tileCount; i++) {
+        std::memcpy(&record, records + i * sizeof(FileTile), sizeof(FileTile));
+        if (record.texture < counts.size())
+            counts[record.texture]++;
+    }
+    const uint64_t chunkKey =
+        (static_cast<uint64_t>(static_cast<uint32_t>(entry.chunk.x)) << 32) |
+        static_cast<uint32_t>(entry.chunk.y);
+    // Bounds from the file, a default chunk would stretch them to (0, 0)
+    const auto [it, created] = chunks.try_emplace(chunkKey);
+    Chunk &chunk = it->second;
+    if (created) {
+        chunk.min = entry.min;
+        chunk.max = entry.max;
+    }
+    for (size_t t = 0; t < counts.size(); t++) {
+        if (counts[t] == 0 || m_FileTextures[t] == nullptr)
+            continue;
+        TileBatch &batch = chunk.batches[m_FileTextures[t]->tex];
+        batch.vertices.reserve(batch.vertices.size() +
+                               static_cast<size_t>(counts[t]) * floatsPerQuad);
+        batch.owners.reserve(batch.owners.size() + counts[t]);
+    }
+
+    for (uint32_t i = 0; i < entry.tileCount; i++) {
+        std::memcpy(&record, records + i * sizeof(FileTile), sizeof(FileTile));
+        if (record.texture >= m_FileTextures.size() ||
+            m_FileTextures[record.texture] == nullptr)
+            continue;
+        const uint32_t index = m_AddTile(record.pos, record.size,
+                                         m_FileTextures[record.texture]);
+        if (index != noTile)
+            tiles[index].isCollidable = (record.flags & collidableFlag) != 0;
+    }
+    if (chunk.batches.empty())
+        chunks.erase(chunkKey);
+}
+
+bool Tilemap::Load(const std::string &filePath,
+                   const std::vector<const Texture2D *> &textures) {
+    if (!Open(filePath, textures))
+        return false;
+    const float infinity = std::numeric_limits<float>::infinity();
+    StreamChunks(glm::vec2(-infinity), glm::vec2(infinity));
+    return true;
 }
 } // namespace CPL
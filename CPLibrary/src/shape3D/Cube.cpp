@@ -2,6 +2,7 @@
 #include "../../include/shape2D/Texture2D.h"
 #include "../../include/shape3D/Cube.h"
 #include "../../include/Shader.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 Cube::Cube(const glm::vec3 &pos, const glm::vec3 &size, const Color &color)
@@ -60,11 +61,10 @@ Cube::Cube(const glm::vec3 &pos, const glm::vec3 &size, const Color &color)
         -sx,  sy, sz,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f
     };
 
-
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
@@ -78,17 +78,14 @@ Cube::Cube(const glm::vec3 &pos, const glm::vec3 &size, const Color &color)
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
                           reinterpret_cast<void *>(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 Cube::~Cube() {
     if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::DeleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::DeleteBuffer(m_VBO);
         m_VBO = 0;
     }
 }
@@ -97,16 +94,14 @@ void Cube::Draw(const Shader &shader) const {
     auto transform = glm::mat4(1.0f);
 
     shader.SetMatrix4fv("transform", transform);
+    shader.SetMatrix3fv("normalMatrix", glm::mat3(1.0f));
     shader.SetVector3f("offset", pos);
     shader.SetColor("objColor", color);
 
     shader.SetInt("tex", 0);
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, Engine::GetWhiteTex()->tex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, Engine::GetWhiteTex()->tex);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 void Cube::DrawDepth(const Shader &shader) const {
     auto model = glm::mat4(1.0f);
@@ -115,8 +110,7 @@ void Cube::DrawDepth(const Shader &shader) const {
     shader.Use();
     shader.SetMatrix4fv("model", model);
 
-    glBindVertexArray(m_VAO);
+    GLState::BindVertexArray(m_VAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
 }
 } // namespace CPL
@@ -1,6 +1,7 @@
 #include "../../include/shape3D/CubeMap.h"
 #include "../../include/Shader.h"
 #include "glm/trigonometric.hpp"
+#include "../../include/util/GLState.h"
 #include <stb_image.h>
 
 namespace CPL {
@@ -61,8 +62,8 @@ void CubeMap::m_Init() {
 
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
@@ -72,7 +73,7 @@ void CubeMap::m_Init() {
 uint32_t CubeMap::LoadCubeMapFromImages(const std::vector<std::string> &faces) {
     uint32_t texID = 0;
     glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+    GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, texID);
 
     int width = 0;
     int height = 0;
@@ -139,7 +140,7 @@ uint32_t CubeMap::LoadCubeMapFromCross(const std::string &path) {
 
     uint32_t texID = 0;
     glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+    GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, texID);
 
     int faceWidth = width / 4;
     int faceHeight = height / 3;
@@ -178,7 +179,7 @@ uint32_t CubeMap::LoadCubeMapFromCross(const std::string &path) {
 }
 
 void CubeMap::Draw(const Shader &shader) const {
-    glDepthFunc(GL_LEQUAL);
+    GLState::DepthFunc(GL_LEQUAL);
     shader.Use();
     auto view = GetCam3D().GetViewMatrix();
     glm::mat4 boxView = glm::mat4(glm::mat3(view));
@@ -198,11 +199,9 @@ void CubeMap::Draw(const Shader &shader) const {
         "projection",
         GetCam3D().GetProjectionMatrix(GetScreenWidth() / GetScreenHeight()) *
             finalView);
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_CubeMapTex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, m_CubeMapTex);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glDepthFunc(GL_LESS);
+    GLState::DepthFunc(GL_LESS);
 }
 } // namespace CPL
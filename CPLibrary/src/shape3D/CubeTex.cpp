@@ -3,6 +3,7 @@
 #include "../../include/Shader.h"
 #include "../../include/shape2D/Texture2D.h"
 #include "../../include/shape3D/Cube.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 CubeTex::CubeTex(const glm::vec3 &pos, const glm::vec3 &size,
@@ -64,8 +65,8 @@ CubeTex::CubeTex(const glm::vec3 &pos, const glm::vec3 &size,
 
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(),
                  GL_STATIC_DRAW);
 
@@ -81,9 +82,6 @@ CubeTex::CubeTex(const glm::vec3 &pos, const glm::vec3 &size,
                           reinterpret_cast<void *>(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
     m_InitAtlas();
 }
 
@@ -147,8 +145,8 @@ void CubeTex::m_InitAtlas() {
 
     glGenVertexArrays(1, &m_VAOAtlas);
     glGenBuffers(1, &m_VBOAtlas);
-    glBindVertexArray(m_VAOAtlas);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBOAtlas);
+    GLState::BindVertexArray(m_VAOAtlas);
+    GLState::BindArrayBuffer(m_VBOAtlas);
     glBufferData(GL_ARRAY_BUFFER, sizeof(atlasVertices), atlasVertices.data(),
                  GL_STATIC_DRAW);
 
@@ -161,26 +159,23 @@ void CubeTex::m_InitAtlas() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
                           reinterpret_cast<void *>(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
 CubeTex::~CubeTex() {
     if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::DeleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::DeleteBuffer(m_VBO);
         m_VBO = 0;
     }
     if (m_VAOAtlas != 0 && glIsVertexArray(m_VAOAtlas)) {
-        glDeleteVertexArrays(1, &m_VAOAtlas);
+        GLState::DeleteVertexArray(m_VAOAtlas);
         m_VAOAtlas = 0;
     }
     if (m_VBOAtlas != 0 && glIsBuffer(m_VBOAtlas)) {
-        glDeleteBuffers(1, &m_VBOAtlas);
+        GLState::DeleteBuffer(m_VBOAtlas);
         m_VBOAtlas = 0;
     }
 }
@@ -189,15 +184,13 @@ void CubeTex::Draw(const Shader &shader, const Texture2D *const tex) const {
     auto transform = glm::mat4(1.0f);
 
     shader.SetMatrix4fv("transform", transform);
+    shader.SetMatrix3fv("normalMatrix", glm::mat3(1.0f));
     shader.SetVector3f("offset", pos);
     shader.SetColor("objColor", color);
     shader.SetInt("tex", 0);
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex->tex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, tex->tex);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 void CubeTex::DrawDepth(const Shader &shader,
                         const Texture2D *const tex) const {
@@ -208,28 +201,23 @@ void CubeTex::DrawDepth(const Shader &shader,
     shader.SetMatrix4fv("model", model);
     shader.SetInt("tex", 0);
 
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex->tex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, tex->tex);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 void CubeTex::DrawAtlas(const Shader &shader,
                         const Texture2D *const atlasTex) const {
     auto transform = glm::mat4(1.0f);
 
     shader.SetMatrix4fv("transform", transform);
+    shader.SetMatrix3fv("normalMatrix", glm::mat3(1.0f));
     shader.SetVector3f("offset", pos);
     shader.SetColor("objColor", color);
     shader.SetInt("tex", 0);
 
-    glBindVertexArray(m_VAOAtlas);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, atlasTex->tex);
+    GLState::BindVertexArray(m_VAOAtlas);
+    GLState::BindTexture(0, GL_TEXTURE_2D, atlasTex->tex);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 void CubeTex::DrawDepthAtlas(const Shader &shader,
                              const Texture2D *const atlasTex) const {
@@ -240,11 +228,8 @@ void CubeTex::DrawDepthAtlas(const Shader &shader,
     shader.SetMatrix4fv("model", model);
     shader.SetInt("tex", 0);
 
-    glBindVertexArray(m_VAOAtlas);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, atlasTex->tex);
+    GLState::BindVertexArray(m_VAOAtlas);
+    GLState::BindTexture(0, GL_TEXTURE_2D, atlasTex->tex);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 } // namespace CPL
@@ -0,0 +1,219 @@
+#include "../../include/shape3D/InstanceBatch.h"
+#include "../../include/CPL.h"
+#include "../../include/Shader.h"
+#include "../../include/shape3D/SphereGeometry.h"
+#include "../../include/util/BatchBuffer.h"
+#include "../../include/util/GLState.h"
+#include <algorithm>
+
+namespace CPL {
+InstanceBatch::~InstanceBatch() {
+    for (uint32_t *VAO : {&m_CubeVAO, &m_SphereVAO}) {
+        if (*VAO != 0 && glIsVertexArray(*VAO)) {
+            GLState::DeleteVertexArray(*VAO);
+            *VAO = 0;
+        }
+    }
+    if (m_CubeVBO != 0 && glIsBuffer(m_CubeVBO)) {
+        GLState::DeleteBuffer(m_CubeVBO);
+        m_CubeVBO = 0;
+    }
+    if (m_InstanceVBO != 0 && glIsBuffer(m_InstanceVBO)) {
+        GLState::DeleteBuffer(m_InstanceVBO);
+        m_InstanceVBO = 0;
+    }
+}
+
+void InstanceBatch::Init(const uint32_t maxInstances) {
+    m_MaxInstances = maxInstances;
+    m_Entries.reserve(maxInstances);
+    m_Instances.reserve(maxInstances);
+    m_Sorted.reserve(maxInstances);
+
+    glGenBuffers(1, &m_InstanceVBO);
+    GLState::BindArrayBuffer(m_InstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(maxInstances * sizeof(Instance)),
+                 nullptr, GL_STREAM_DRAW);
+
+    // Same faces as CubeTex with a size of 1, atlas coordinates of the 3x2
+    // layout next to the plain ones
+    constexpr float s = 0.5f;
+    constexpr float w = 1.0f / 3.0f;
+    constexpr float h = 1.0f / 2.0f;
+    const std::vector<float> cube = {
+        // Back face (Z-)
+        -s, -s, -s,  0.0f, 0.0f, -1.0f,  0.0f, 0.0f,  2 * w, 2 * h,
+         s,  s, -s,  0.0f, 0.0f, -1.0f,  1.0f, 1.0f,  3 * w, 1 * h,
+         s, -s, -s,  0.0f, 0.0f, -1.0f,  1.0f, 0.0f,  3 * w, 2 * h,
+         s,  s, -s,  0.0f, 0.0f, -1.0f,  1.0f, 1.0f,  3 * w, 1 * h,
+        -s, -s, -s,  0.0f, 0.0f, -1.0f,  0.0f, 0.0f,  2 * w, 2 * h,
+        -s,  s, -s,  0.0f, 0.0f, -1.0f,  0.0f, 1.0f,  2 * w, 1 * h,
+
+        // Front face (Z+)
+        -s, -s,  s,  0.0f, 0.0f, 1.0f,  0.0f, 0.0f,  1 * w, 1 * h,
+         s, -s,  s,  0.0f, 0.0f, 1.0f,  1.0f, 0.0f,  2 * w, 1 * h,
+         s,  s,  s,  0.0f, 0.0f, 1.0f,  1.0f, 1.0f,  2 * w, 0 * h,
+         s,  s,  s,  0.0f, 0.0f, 1.0f,  1.0f, 1.0f,  2 * w, 0 * h,
+        -s,  s,  s,  0.0f, 0.0f, 1.0f,  0.0f, 1.0f,  1 * w, 0 * h,
+        -s, -s,  s,  0.0f, 0.0f, 1.0f,  0.0f, 0.0f,  1 * w, 1 * h,
+
+        // Left face (X-)
+        -s,  s,  s,  -1.0f, 0.0f, 0.0f,  1.0f, 0.0f,  3 * w, 0 * h,
+        -s,  s, -s,  -1.0f, 0.0f, 0.0f,  1.0f, 1.0f,  2 * w, 0 * h,
+        -s, -s, -s,  -1.0f, 0.0f, 0.0f,  0.0f, 1.0f,  2 * w, 1 * h,
+        -s, -s, -s,  -1.0f, 0.0f, 0.0f,  0.0f, 1.0f,  2 * w, 1 * h,
+        -s, -s,  s,  -1.0f, 0.0f, 0.0f,  0.0f, 0.0f,  3 * w, 1 * h,
+        -s,  s,  s,  -1.0f, 0.0f, 0.0f,  1.0f, 0.0f,  3 * w, 0 * h,
+
+        // Right face (X+)
+         s,  s,  s,  1.0f, 0.0f, 0.0f,  1.0f, 0.0f,  1 * w, 0 * h,
+         s, -s, -s,  1.0f, 0.0f, 0.0f,  0.0f, 1.0f,  0 * w, 1 * h,
+         s,  s, -s,  1.0f, 0.0f, 0.0f,  1.0f, 1.0f,  0 * w, 0 * h,
+         s, -s, -s,  1.0f, 0.0f, 0.0f,  0.0f, 1.0f,  0 * w, 1 * h,
+         s,  s,  s,  1.0f, 0.0f, 0.0f,  1.0f, 0.0f,  1 * w, 0 * h,
+         s, -s,  s,  1.0f, 0.0f, 0.0f,  0.0f, 0.0f,  1 * w, 1 * h,
+
+        // Bottom face (Y-)
+        -s, -s, -s,  0.0f, -1.0f, 0.0f,  0.0f, 1.0f,  0 * w, 1 * h,
+         s, -s, -s,  0.0f, -1.0f, 0.0f,  1.0f, 1.0f,  1 * w, 1 * h,
+         s, -s,  s,  0.0f, -1.0f, 0.0f,  1.0f, 0.0f,  1 * w, 2 * h,
+         s, -s,  s,  0.0f, -1.0f, 0.0f,  1.0f, 0.0f,  1 * w, 2 * h,
+        -s, -s,  s,  0.0f, -1.0f, 0.0f,  0.0f, 0.0f,  0 * w, 2 * h,
+        -s, -s, -s,  0.0f, -1.0f, 0.0f,  0.0f, 1.0f,  0 * w, 1 * h,
+
+        // Top face (Y+)
+        -s,  s, -s,  0.0f, 1.0f, 0.0f,  0.0f, 1.0f,  1 * w, 1 * h,
+         s,  s,  s,  0.0f, 1.0f, 0.0f,  1.0f, 0.0f,  2 * w, 2 * h,
+         s,  s, -s,  0.0f, 1.0f, 0.0f,  1.0f, 1.0f,  2 * w, 1 * h,
+         s,  s,  s,  0.0f, 1.0f, 0.0f,  1.0f, 0.0f,  2 * w, 2 * h,
+        -s,  s, -s,  0.0f, 1.0f, 0.0f,  0.0f, 1.0f,  1 * w, 1 * h,
+        -s,  s,  s,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f,  1 * w, 2 * h
+    };
+
+    glGenVertexArrays(1, &m_CubeVAO);
+    glGenBuffers(1, &m_CubeVBO);
+    GLState::BindVertexArray(m_CubeVAO);
+    GLState::BindArrayBuffer(m_CubeVBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(cube.size() * sizeof(float)),
+                 cube.data(), GL_STATIC_DRAW);
+    m_SetupVAO(10, 8);
+    m_Meshes.push_back({m_CubeVAO, false, 0, 36});
+
+    // Shares the buffers of SphereGeometry, spheres have no atlas
+    // coordinates so the plain ones are used for both
+    glGenVertexArrays(1, &m_SphereVAO);
+    GLState::BindVertexArray(m_SphereVAO);
+    GLState::BindArrayBuffer(SphereGeometry::GetVBO());
+    GLState::BindElementBuffer(SphereGeometry::GetEBO());
+    m_SetupVAO(8, 6);
+    for (size_t lod = 0; lod < SphereGeometry::stackLODs.size(); lod++) {
+        m_Meshes.push_back({m_SphereVAO, true,
+                            SphereGeometry::GetFirstIndex(lod),
+                            SphereGeometry::GetIndexCount(lod)});
+    }
+}
+
+void InstanceBatch::m_SetupVAO(const int stride, const int atlasOffset) const {
+    const auto strideBytes = static_cast<GLsizei>(stride * sizeof(float));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, strideBytes,
+                          static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, strideBytes,
+                          reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, strideBytes,
+                          reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(
+        3, 2, GL_FLOAT, GL_FALSE, strideBytes,
+        reinterpret_cast<void *>(static_cast<size_t>(atlasOffset) *
+                                 sizeof(float)));
+    glEnableVertexAttribArray(3);
+
+    // Per instance attributes, pointed at the current run in Flush
+    GLState::BindArrayBuffer(m_InstanceVBO);
+    m_SetInstanceAttributes(0);
+    for (uint32_t location = 4; location <= 7; location++) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+void InstanceBatch::m_SetInstanceAttributes(const size_t firstInstance) const {
+    const size_t base = firstInstance * sizeof(Instance);
+    glVertexAttribPointer(
+        4, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        reinterpret_cast<void *>(base + offsetof(Instance, offset)));
+    glVertexAttribPointer(
+        5, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        reinterpret_cast<void *>(base + offsetof(Instance, size)));
+    glVertexAttribPointer(
+        6, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance),
+        reinterpret_cast<void *>(base + offsetof(Instance, color)));
+    glVertexAttribPointer(
+        7, 1, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        reinterpret_cast<void *>(base + offsetof(Instance, atlas)));
+}
+
+void InstanceBatch::Add(const Shader &shader, const uint32_t mesh,
+                        const uint32_t texture, const glm::vec3 &pos,
+                        const glm::vec3 &size, const Color &color,
+                        const bool atlas) {
+    if (m_Shader != &shader || m_Instances.size() >= m_MaxInstances) {
+        Flush();
+        m_Shader = &shader;
+        m_InstancedUniform = shader.GetUniform("instanced");
+        m_TexUniform = shader.GetUniform("tex");
+    }
+    m_Entries.push_back({(static_cast<uint64_t>(mesh) << 32) | texture,
+                         static_cast<uint32_t>(m_Instances.size())});
+    m_Instances.push_back(
+        {pos, size, color.Pack(), atlas ? 1.0f : 0.0f});
+}
+
+void InstanceBatch::Flush() {
+    if (m_Instances.empty() || m_Shader == nullptr)
+        return;
+
+    BatchBuffer::SortItems(m_Entries, m_Instances, 1, m_Sorted);
+
+    // The 3D shaders read the transform from the instance attributes
+    // instead of the uniforms while this is set
+    m_Shader->Use();
+    m_Shader->SetBool(m_InstancedUniform, true);
+    m_Shader->SetInt(m_TexUniform, 0);
+
+    GLState::BindArrayBuffer(m_InstanceVBO);
+    BatchBuffer::Upload(m_MaxInstances * sizeof(Instance), m_Sorted.data(),
+                        m_Sorted.size() * sizeof(Instance));
+
+    // One draw per run of instances sharing mesh & texture
+    BatchBuffer::ForEachRun(
+        m_Entries, [](const Entry &e) { return e.key; },
+        [&](const Entry &e, const size_t first, const size_t count) {
+            const Mesh &mesh = m_Meshes[e.key >> 32];
+            GLState::BindVertexArray(mesh.VAO);
+            // GL 3.3 has no base instance, so move the attributes to the run
+            m_SetInstanceAttributes(first);
+            GLState::BindTexture(0, GL_TEXTURE_2D,
+                                 static_cast<uint32_t>(e.key & 0xFFFFFFFF));
+            if (mesh.indexed) {
+                glDrawElementsInstanced(
+                    GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT,
+                    reinterpret_cast<void *>(mesh.first * sizeof(uint32_t)),
+                    static_cast<GLsizei>(count));
+            } else {
+                glDrawArraysInstanced(GL_TRIANGLES, mesh.first, mesh.count,
+                                      static_cast<GLsizei>(count));
+            }
+            m_DrawCalls++;
+        });
+
+    m_Shader->SetBool(m_InstancedUniform, false);
+
+    m_Entries.clear();
+    m_Instances.clear();
+}
+} // namespace CPL
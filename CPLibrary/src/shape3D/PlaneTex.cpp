@@ -2,6 +2,7 @@
 #include "../../include/CPL.h"
 #include "../../include/Shader.h"
 #include "../../include/shape2D/Texture2D.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 PlaneTex::PlaneTex(const glm::vec3 &pos, const glm::vec3 &rot,
@@ -22,8 +23,8 @@ PlaneTex::PlaneTex(const glm::vec3 &pos, const glm::vec3 &rot,
 
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(),
                  GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
@@ -37,18 +38,15 @@ PlaneTex::PlaneTex(const glm::vec3 &pos, const glm::vec3 &rot,
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
                           reinterpret_cast<void *>(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
 PlaneTex::~PlaneTex() {
     if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::DeleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::DeleteBuffer(m_VBO);
         m_VBO = 0;
     }
 }
@@ -66,16 +64,15 @@ void PlaneTex::Draw(const Shader &shader, const Texture2D *const tex) const {
     transform = glm::translate(transform, -center);
 
     shader.SetMatrix4fv("transform", transform);
+    // Only rotations, so the inverse transpose is the rotation itself
+    shader.SetMatrix3fv("normalMatrix", glm::mat3(transform));
     shader.SetVector3f("offset", pos);
     shader.SetColor("objColor", color);
     shader.SetInt("tex", 0);
 
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex->tex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, tex->tex);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 void PlaneTex::DrawDepth(const Shader &shader,
                          const Texture2D *const tex) const {
@@ -93,11 +90,8 @@ void PlaneTex::DrawDepth(const Shader &shader,
     shader.SetMatrix4fv("model", model);
     shader.SetInt("tex", 0);
 
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex->tex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, tex->tex);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 } // namespace CPL
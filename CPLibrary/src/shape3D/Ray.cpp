@@ -1,6 +1,7 @@
 #include "../../include/shape2D/Texture2D.h"
 #include "../../include/shape3D/Ray.h"
 #include "../../include/Shader.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 Ray::Ray(const glm::vec3 &startPos, const glm::vec3 &endPos,
@@ -13,8 +14,8 @@ Ray::Ray(const glm::vec3 &startPos, const glm::vec3 &endPos,
 
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindArrayBuffer(m_VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(),
                  GL_STATIC_DRAW);
 
@@ -29,17 +30,14 @@ Ray::Ray(const glm::vec3 &startPos, const glm::vec3 &endPos,
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
                           reinterpret_cast<void *>(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 Ray::~Ray() {
     if (m_VAO != 0 && glIsVertexArray(m_VAO)) {
-        glDeleteVertexArrays(1, &m_VAO);
+        GLState::DeleteVertexArray(m_VAO);
         m_VAO = 0;
     }
     if (m_VBO != 0 && glIsBuffer(m_VBO)) {
-        glDeleteBuffers(1, &m_VBO);
+        GLState::DeleteBuffer(m_VBO);
         m_VBO = 0;
     }
 }
@@ -50,11 +48,8 @@ void Ray::Draw(const Shader &shader) const {
     shader.SetColor("objColor", color);
 
     shader.SetInt("tex", 0);
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, Engine::GetWhiteTex()->tex);
+    GLState::BindVertexArray(m_VAO);
+    GLState::BindTexture(0, GL_TEXTURE_2D, Engine::GetWhiteTex()->tex);
     glDrawArrays(GL_LINES, 0, 2);
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 } // namespace CPL
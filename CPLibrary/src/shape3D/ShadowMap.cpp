@@ -1,12 +1,13 @@
 #include "../../include/shape3D/ShadowMap.h"
 #include "../../include/Engine.h"
+#include "../../include/util/GLState.h"
 
 namespace CPL {
 ShadowMap::ShadowMap(const uint32_t res) : m_ShadowWidth(res), m_ShadowHeight(res) {
     glGenFramebuffers(1, &m_DepthMapFBO);
 
     glGenTextures(1, &m_DepthMap);
-    glBindTexture(GL_TEXTURE_2D, m_DepthMap);
+    GLState::BindTexture(0, GL_TEXTURE_2D, m_DepthMap);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, static_cast<int>(res),
                  static_cast<int>(res), 0, GL_DEPTH_COMPONENT, GL_FLOAT,
                  nullptr);
@@ -34,28 +35,32 @@ ShadowMap::~ShadowMap() {
         glDeleteFramebuffers(1, &m_DepthMapFBO);
     }
     if (m_DepthMap != 0 && glIsTexture(m_DepthMap)) {
-        glDeleteTextures(1, &m_DepthMap);
+        GLState::DeleteTexture(m_DepthMap);
     }
 }
 
-void ShadowMap::BeginDepthPass(const glm::mat4 &lightSpaceMatrix) const {
-    glViewport(0, 0, static_cast<int>(m_ShadowWidth),
-               static_cast<int>(m_ShadowHeight));
+void ShadowMap::BeginDepthPass(const glm::mat4 &lightSpaceMatrix) {
+    m_LightSpaceMatrix = lightSpaceMatrix;
+    GLState::Viewport(0, 0, static_cast<int>(m_ShadowWidth),
+                      static_cast<int>(m_ShadowHeight));
     glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
     glClear(GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    glCullFace(GL_FRONT);
+    GLState::SetDepthTest(true);
+    GLState::CullFace(GL_FRONT);
+    Engine::BeginDepthPass(lightSpaceMatrix);
 }
 
 void ShadowMap::EndDepthPass() {
+    // Draws the instanced shapes into the shadow map first
+    Engine::EndDepthPass();
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glCullFace(GL_BACK);
-    glViewport(0, 0, static_cast<int>(Engine::GetScreenWidth()),
-               static_cast<int>(Engine::GetScreenHeight()));
+    GLState::CullFace(GL_BACK);
+    GLState::Viewport(0, 0, static_cast<int>(Engine::GetScreenWidth()),
+                      static_cast<int>(Engine::GetScreenHeight()));
 }
 
 void ShadowMap::BindForReading(const uint32_t textureUnit) const {
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, m_DepthMap);
+    GLState::BindTexture(textureUnit, GL_TEXTURE_2D, m_DepthMap);
+    Engine::SetShadowMap(textureUnit, m_LightSpaceMatrix);
 }
 } // namespace CPL
@@ -0,0 +1,119 @@
+#include "../../include/shape3D/SphereGeometry.h"
+#include "../../include/util/GLState.h"
+#include <cmath>
+#include <vector>
+
+namespace CPL {
+uint32_t SphereGeometry::s_VAO = 0, SphereGeometry::s_VBO = 0,
+         SphereGeometry::s_EBO = 0;
+std::array<SphereGeometry::Mesh, SphereGeometry::stackLODs.size()>
+    SphereGeometry::s_Meshes;
+
+void SphereGeometry::Init() {
+    if (s_VAO != 0)
+        return;
+
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    static constexpr float pi = 3.14159f;
+    for (size_t lod = 0; lod < stackLODs.size(); lod++) {
+        const int stacks = stackLODs[lod];
+        const int sectors = stacks * 2;
+        const auto base = static_cast<uint32_t>(vertices.size() / 8);
+
+        for (int i = 0; i <= stacks; ++i) {
+            const float v = static_cast<float>(i) / static_cast<float>(stacks);
+            const float theta = v * pi;
+
+            for (int j = 0; j <= sectors; ++j) {
+                const float u =
+                    static_cast<float>(j) / static_cast<float>(sectors);
+                const float phi = u * 2.0f * pi;
+
+                // Position on the unit sphere is also the normal
+                const glm::vec3 pos = {std::sin(theta) * std::cos(phi),
+                                       std::cos(theta),
+                                       std::sin(theta) * std::sin(phi)};
+                vertices.insert(vertices.end(), {pos.x, pos.y, pos.z, pos.x,
+                                                 pos.y, pos.z, u, 1.0f - v});
+            }
+        }
+
+        s_Meshes[lod].first = static_cast<int>(indices.size());
+        for (int i = 0; i < stacks; ++i) {
+            for (int j = 0; j < sectors; ++j) {
+                const auto first =
+                    base + static_cast<uint32_t>((i * (sectors + 1)) + j);
+                const auto second = first + static_cast<uint32_t>(sectors) + 1;
+                indices.insert(indices.end(), {first, first + 1, second,
+                                               first + 1, second + 1, second});
+            }
+        }
+        s_Meshes[lod].count =
+            static_cast<int>(indices.size()) - s_Meshes[lod].first;
+    }
+
+    glGenVertexArrays(1, &s_VAO);
+    glGenBuffers(1, &s_VBO);
+    glGenBuffers(1, &s_EBO);
+    GLState::BindVertexArray(s_VAO);
+    GLState::BindArrayBuffer(s_VBO);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(vertices.size() * sizeof(float)),
+                 vertices.data(), GL_STATIC_DRAW);
+    GLState::BindElementBuffer(s_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)),
+                 indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
+void SphereGeometry::Destroy() {
+    if (s_VAO != 0 && glIsVertexArray(s_VAO)) {
+        GLState::DeleteVertexArray(s_VAO);
+    }
+    if (s_VBO != 0 && glIsBuffer(s_VBO)) {
+        GLState::DeleteBuffer(s_VBO);
+    }
+    if (s_EBO != 0 && glIsBuffer(s_EBO)) {
+        GLState::DeleteBuffer(s_EBO);
+    }
+    s_VAO = 0;
+    s_VBO = 0;
+    s_EBO = 0;
+}
+
+size_t SphereGeometry::GetLOD(const glm::vec3 &pos, const float radius) {
+    const Camera3D &cam = Engine::GetCam3D();
+    const float dist = glm::length(pos - cam.position);
+    if (dist <= radius)
+        return stackLODs.size() - 1;
+
+    // Height of the sphere on screen in pixels
+    const float pixels = radius /
+                         (dist * std::tan(glm::radians(cam.fov) * 0.5f)) *
+                         Engine::GetScreenHeight();
+    // About one ring every 4 pixels
+    for (size_t lod = 0; lod < stackLODs.size(); lod++) {
+        if (static_cast<float>(stackLODs[lod]) * 4.0f >= pixels)
+            return lod;
+    }
+    return stackLODs.size() - 1;
+}
+
+void SphereGeometry::Draw(const size_t lod) {
+    GLState::BindVertexArray(s_VAO);
+    glDrawElements(GL_TRIANGLES, s_Meshes[lod].count, GL_UNSIGNED_INT,
+                   reinterpret_cast<void *>(s_Meshes[lod].first *
+                                            sizeof(uint32_t)));
+}
+} // namespace CPL
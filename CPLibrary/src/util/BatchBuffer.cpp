@@ -0,0 +1,11 @@
+#include "../../include/util/BatchBuffer.h"
+#include <glad/glad.h>
+
+namespace CPL {
+void BatchBuffer::Upload(const size_t capacity, const void *const data,
+                         const size_t size) {
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+}
+} // namespace CPL
@@ -0,0 +1,135 @@
+#include "../../include/util/GLState.h"
+
+namespace CPL {
+GLState::Cache GLState::s_Cache;
+GLState::Stats GLState::s_Frame, GLState::s_LastFrame;
+
+void GLState::UseProgram(const uint32_t program) {
+    if (m_Changed(s_Cache.program, program))
+        glUseProgram(program);
+}
+
+void GLState::BindVertexArray(const uint32_t VAO) {
+    if (m_Changed(s_Cache.VAO, VAO)) {
+        glBindVertexArray(VAO);
+        s_Cache.elementBuffer = unknown;
+    }
+}
+
+void GLState::BindArrayBuffer(const uint32_t buffer) {
+    if (m_Changed(s_Cache.arrayBuffer, buffer))
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void GLState::BindElementBuffer(const uint32_t buffer) {
+    if (m_Changed(s_Cache.elementBuffer, buffer))
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+}
+
+void GLState::BindTexture(const uint32_t unit, const GLenum target,
+                          const uint32_t texture) {
+    uint32_t &cached =
+        s_Cache.textures[unit][target == GL_TEXTURE_CUBE_MAP ? 1 : 0];
+    if (cached == texture) {
+        s_Frame.elided++;
+        return;
+    }
+    if (m_Changed(s_Cache.activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+    cached = texture;
+    s_Frame.issued++;
+    glBindTexture(target, texture);
+}
+
+void GLState::m_SetCapability(const GLenum capability, int8_t &cached,
+                              const bool enabled) {
+    if (!m_Changed(cached, static_cast<int8_t>(enabled)))
+        return;
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GLState::SetBlend(const bool enabled) {
+    m_SetCapability(GL_BLEND, s_Cache.blend, enabled);
+}
+
+void GLState::BlendFunc(const GLenum src, const GLenum dst) {
+    if (s_Cache.blendSrc == src && s_Cache.blendDst == dst) {
+        s_Frame.elided++;
+        return;
+    }
+    s_Cache.blendSrc = src;
+    s_Cache.blendDst = dst;
+    s_Frame.issued++;
+    glBlendFunc(src, dst);
+}
+
+void GLState::SetDepthTest(const bool enabled) {
+    m_SetCapability(GL_DEPTH_TEST, s_Cache.depthTest, enabled);
+}
+
+void GLState::SetDepthMask(const bool enabled) {
+    if (m_Changed(s_Cache.depthMask, static_cast<int8_t>(enabled)))
+        glDepthMask(static_cast<GLboolean>(enabled));
+}
+
+void GLState::DepthFunc(const GLenum func) {
+    if (m_Changed(s_Cache.depthFunc, func))
+        glDepthFunc(func);
+}
+
+void GLState::SetCullFace(const bool enabled) {
+    m_SetCapability(GL_CULL_FACE, s_Cache.cullFace, enabled);
+}
+
+void GLState::CullFace(const GLenum face) {
+    if (m_Changed(s_Cache.cullFaceMode, face))
+        glCullFace(face);
+}
+
+void GLState::Viewport(const int x, const int y, const int width,
+                       const int height) {
+    if (m_Changed(s_Cache.viewport, std::array<int, 4>{x, y, width, height}))
+        glViewport(x, y, width, height);
+}
+
+void GLState::DeleteVertexArray(const uint32_t VAO) {
+    // Deleting the bound VAO binds 0
+    if (s_Cache.VAO == VAO) {
+        s_Cache.VAO = 0;
+        s_Cache.elementBuffer = unknown;
+    }
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void GLState::DeleteBuffer(const uint32_t buffer) {
+    if (s_Cache.arrayBuffer == buffer)
+        s_Cache.arrayBuffer = 0;
+    // Could still be the element buffer of another VAO
+    s_Cache.elementBuffer = unknown;
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLState::DeleteTexture(const uint32_t texture) {
+    for (auto &unit : s_Cache.textures) {
+        for (uint32_t &bound : unit) {
+            if (bound == texture)
+                bound = 0;
+        }
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::Invalidate() {
+    s_Cache = Cache();
+    for (auto &unit : s_Cache.textures)
+        unit.fill(unknown);
+}
+
+void GLState::NewFrame() {
+    s_LastFrame = s_Frame;
+    s_Frame = Stats();
+}
+} // namespace CPL
@@ -0,0 +1,82 @@
+#include "../../include/util/MappedFile.h"
+#include "../../include/util/Logging.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+// wingdi.h defines ERROR, which breaks Logging::MessageStates::ERROR
+#define NOGDI
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CPL {
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &filePath) {
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        Logging::Log(Logging::MessageStates::ERROR,
+                     "Could not open " + filePath);
+        return;
+    }
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file, &size);
+    // The mapping keeps the file open, so the handles can be closed
+    HANDLE mapping =
+        size.QuadPart > 0
+            ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)
+            : nullptr;
+    CloseHandle(file);
+    if (mapping == nullptr)
+        return;
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr)
+        return;
+    m_Data = static_cast<const uint8_t *>(data);
+    m_Size = static_cast<size_t>(size.QuadPart);
+}
+
+void MappedFile::m_Unmap() {
+    if (m_Data != nullptr)
+        UnmapViewOfFile(m_Data);
+    m_Data = nullptr;
+    m_Size = 0;
+}
+#else
+MappedFile::MappedFile(const std::string &filePath) {
+    const int file = open(filePath.c_str(), O_RDONLY);
+    if (file < 0) {
+        Logging::Log(Logging::MessageStates::ERROR,
+                     "Could not open " + filePath);
+        return;
+    }
+    struct stat info {};
+    if (fstat(file, &info) != 0 || info.st_size <= 0) {
+        close(file);
+        return;
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                      MAP_PRIVATE, file, 0);
+    // The mapping keeps the file open
+    close(file);
+    if (data == MAP_FAILED)
+        return;
+    m_Data = static_cast<const uint8_t *>(data);
+    m_Size = static_cast<size_t>(info.st_size);
+}
+
+void MappedFile::m_Unmap() {
+    if (m_Data != nullptr)
+        munmap(const_cast<uint8_t *>(m_Data), m_Size);
+    m_Data = nullptr;
+    m_Size = 0;
+}
+#endif
+} // namespace CPL
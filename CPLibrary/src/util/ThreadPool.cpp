@@ -0,0 +1,83 @@
+#include "../../include/util/ThreadPool.h"
+#include <algorithm>
+
+namespace CPL {
+ThreadPool::ThreadPool(uint32_t workers) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    workers = 0;
+#else
+    if (workers == 0) {
+        // hardware_concurrency can be 0 if it is unknown
+        workers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    }
+#endif
+    m_Workers.reserve(workers);
+    for (uint32_t i = 0; i < workers; i++)
+        m_Workers.emplace_back(&ThreadPool::m_WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread &worker : m_Workers)
+        worker.join();
+}
+
+ThreadPool &ThreadPool::GetShared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::ParallelFor(const uint32_t count,
+                             const std::function<void(uint32_t)> &task) {
+    if (count == 0)
+        return;
+    if (m_Workers.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; i++)
+            task(i);
+        return;
+    }
+
+    {
+        const std::lock_guard lock(m_Mutex);
+        m_Task = &task;
+        m_Count = count;
+        m_Next.store(0, std::memory_order_relaxed);
+        m_Busy = static_cast<uint32_t>(m_Workers.size());
+        m_Job++;
+    }
+    m_Wake.notify_all();
+    m_RunTasks();
+
+    // Every worker has to leave the job before task goes out of scope
+    std::unique_lock lock(m_Mutex);
+    m_Done.wait(lock, [this] { return m_Busy == 0; });
+    m_Task = nullptr;
+}
+
+void ThreadPool::m_RunTasks() {
+    for (uint32_t i = m_Next.fetch_add(1, std::memory_order_relaxed);
+         i < m_Count; i = m_Next.fetch_add(1, std::memory_order_relaxed))
+        (*m_Task)(i);
+}
+
+void ThreadPool::m_WorkerLoop() {
+    uint64_t lastJob = 0;
+    std::unique_lock lock(m_Mutex);
+    while (true) {
+        m_Wake.wait(lock, [&] { return m_Stop || m_Job != lastJob; });
+        if (m_Stop)
+            return;
+        lastJob = m_Job;
+
+        lock.unlock();
+        m_RunTasks();
+        lock.lock();
+        if (--m_Busy == 0)
+            m_Done.notify_one();
+    }
+}
+} // namespace CPL
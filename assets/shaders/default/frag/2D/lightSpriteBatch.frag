@@ -0,0 +1,62 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 FragPos;
+in vec2 TexCoord;
+in vec4 VertexColor;
+
+uniform sampler2D ourTexture;
+
+struct PointLight {
+    vec2 position;
+    float radius;
+    float intensity;
+    vec4 color;
+};
+
+struct GlobalLight {
+    float intensity;
+    vec4 color;
+};
+
+// Shared by every 2D light shader (UniformBlocks::Lights2D)
+layout (std140) uniform Lights2D {
+    GlobalLight globalLight;
+    float ambient;
+    int numPointLights;
+    PointLight pointLights[32]; // Maximum are 32 point lights
+};
+
+vec3 CalcPointLight(PointLight l, vec2 fragPos, float ambient) {
+    float dist = length(l.position - fragPos);
+    float falloff = clamp(1.0 - dist / l.radius, 0.0, 1.0);
+
+    vec3 lightCol = l.color.rgb / 255.0 * l.intensity;
+
+    falloff = falloff * falloff; // optional smooth
+
+    return (ambient + falloff) * lightCol;
+}
+
+vec3 CalcGlobalLight(GlobalLight l) {
+    vec3 lightCol = l.color.rgb / 255.0 * l.intensity;
+    return lightCol;
+}
+
+void main() 
+{
+    vec4 textureColor = texture(ourTexture, TexCoord);
+    if (textureColor.a < 0.1) discard;
+
+    vec3 result = vec3(ambient);
+
+    for (int i = 0; i < numPointLights; i++) {
+        result += CalcPointLight(pointLights[i], FragPos, ambient); 
+    }
+    result += CalcGlobalLight(globalLight);
+
+    vec3 obj = VertexColor.rgb * textureColor.rgb;
+    vec3 finalColor = obj * result;
+
+    FragColor = vec4(finalColor, VertexColor.a * textureColor.a);
+}
@@ -5,7 +5,6 @@ in vec2 FragPos;
 in vec2 TexCoord;
 
 uniform vec4 inputColor;
-uniform float ambient;
 uniform sampler2D ourTexture;
 
 struct PointLight {
@@ -20,9 +19,13 @@ struct GlobalLight {
     vec4 color;
 };
 
-uniform int numPointLights;
-uniform PointLight pointLights[32]; // Maximum are 32 point lights
-uniform GlobalLight globalLight;
+// Shared by every 2D light shader (UniformBlocks::Lights2D)
+layout (std140) uniform Lights2D {
+    GlobalLight globalLight;
+    float ambient;
+    int numPointLights;
+    PointLight pointLights[32]; // Maximum are 32 point lights
+};
 
 vec3 CalcPointLight(PointLight l, vec2 fragPos, float ambient) {
     float dist = length(l.position - fragPos);
@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 VertexColor;
+
+uniform sampler2D ourTexture;
+
+void main()
+{
+    vec4 textureColor = texture(ourTexture, TexCoord);
+    if (textureColor.a < 0.1) discard;
+    FragColor = VertexColor * textureColor;
+}
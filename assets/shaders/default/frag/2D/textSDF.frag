@@ -0,0 +1,34 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D text;
+uniform vec3 textColor;
+// Distance field: 0.5 on the outline, larger inside the glyph
+uniform float outlineWidth;
+uniform vec4 outlineColor;
+uniform vec2 shadowOffset;
+uniform vec4 shadowColor;
+
+float Coverage(float dist, float edge, float smoothing) {
+    return smoothstep(edge - smoothing, edge + smoothing, dist);
+}
+
+void main() {
+    float dist = texture(text, TexCoords).r;
+    // About one pixel of antialiasing at every scale
+    float smoothing = max(fwidth(dist) * 0.5, 0.0001);
+
+    float fill = Coverage(dist, 0.5, smoothing);
+    float outline = Coverage(dist, 0.5 - outlineWidth, smoothing);
+    vec4 glyph = mix(vec4(outlineColor.rgb / 255.0, outline * outlineColor.a / 255.0),
+                     vec4(textColor / 255.0, 1.0), fill);
+
+    float shadowDist = texture(text, TexCoords - shadowOffset).r;
+    float shadow = Coverage(shadowDist, 0.5 - outlineWidth, smoothing) * shadowColor.a / 255.0;
+
+    // Glyph over its shadow
+    float alpha = glyph.a + shadow * (1.0 - glyph.a);
+    vec3 rgb = (glyph.rgb * glyph.a + shadowColor.rgb / 255.0 * shadow * (1.0 - glyph.a)) / max(alpha, 0.0001);
+    color = vec4(rgb, alpha);
+}
\ No newline at end of file
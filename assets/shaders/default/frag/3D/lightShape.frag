@@ -1,10 +1,25 @@
 #version 330 core
+// Variants (see ShaderVariants), defaults are the most expensive path:
+// MAX_POINT_LIGHTS  point lights looped over (0 skips the loop)
+// USE_SHADOWS       sample shadowMap with lightSpaceMatrix
+// PCF_KERNEL        shadow filter radius in texels, 1 = 3x3
+// USE_FOG           mix in the fog color
+#ifndef MAX_POINT_LIGHTS
+#define MAX_POINT_LIGHTS 32
+#endif
+#ifndef PCF_KERNEL
+#define PCF_KERNEL 1
+#endif
+
 out vec4 FragColor;
 
 in vec2 TexCoord;
 in vec3 Normal;  
 in vec3 FragPos;
+#ifdef USE_SHADOWS
 in vec4 FragPosLightSpace;
+#endif
+in vec4 ObjColor;
 
 struct PointLight {
     vec3 position;
@@ -22,20 +37,34 @@ struct DirectionalLight {
     vec3 specular;
 };
 
-uniform float shininess;
-uniform int numPointLights;
-uniform PointLight pointLights[32];
-uniform DirectionalLight dirLight;
-uniform vec3 viewPos;
-uniform vec4 objColor;
+// Shared by every 3D light shader (UniformBlocks::Lights3D)
+layout (std140) uniform Lights3D {
+    DirectionalLight dirLight;
+    float shininess;
+    int numPointLights;
+    PointLight pointLights[32]; // Maximum are 32 point lights
+};
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
 uniform sampler2D tex;
+#ifdef USE_SHADOWS
 uniform sampler2D shadowMap; 
+#endif
 
-uniform bool useFog;
-uniform float fogStart;
-uniform float fogEnd;
-uniform vec4 fogColor;
+#ifdef USE_FOG
+// Shared by every 3D shader (UniformBlocks::Fog)
+layout (std140) uniform Fog {
+    vec4 fogColor;
+    float fogStart;
+    float fogEnd;
+    bool useFog;
+};
+#endif
 
+#ifdef USE_SHADOWS
 float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     
@@ -48,19 +77,20 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
     
     float shadow = 0.0;
     vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-    for(int x = -1; x <= 1; ++x) {
-        for(int y = -1; y <= 1; ++y) {
+    for(int x = -PCF_KERNEL; x <= PCF_KERNEL; ++x) {
+        for(int y = -PCF_KERNEL; y <= PCF_KERNEL; ++y) {
             float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }
-    shadow /= 9.0;
+    shadow /= float((2 * PCF_KERNEL + 1) * (2 * PCF_KERNEL + 1));
     
     if(projCoords.z > 1.0)
         shadow = 0.0;
     
     return shadow;
 }
+#endif
 
 vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir) {
     vec3 lightDir = normalize(-light.direction);
@@ -106,23 +136,33 @@ void main() {
     
     vec3 lighting = CalcDirLight(dirLight, normal, viewDir);
     
-    for(int i = 0; i < numPointLights; i++)
+#if MAX_POINT_LIGHTS > 0
+    for(int i = 0; i < MAX_POINT_LIGHTS; i++) {
+        if (i >= numPointLights) break;
         lighting += CalcPointLight(pointLights[i], normal, FragPos, viewDir);
+    }
+#endif
     
+#ifdef USE_SHADOWS
     vec3 lightDir = normalize(-dirLight.direction);
     float shadow = ShadowCalculation(FragPosLightSpace, normal, lightDir);
     
     vec3 ambient = dirLight.ambient;
     vec3 diffuseSpecular = lighting - ambient;
     lighting = ambient + (1.0 - shadow) * diffuseSpecular;
+#endif
     
-    vec3 baseColor = objColor.rgb / 255 * texColor.rgb;
+    vec3 baseColor = ObjColor.rgb / 255 * texColor.rgb;
     vec3 result = baseColor * lighting;
 
+#ifdef USE_FOG
     float dist = length(FragPos.xz - viewPos.xz);
     float fogFactor = clamp((fogStart - dist) / (fogStart - fogEnd), 0.0, 1.0);
 
-    vec3 finalColor = useFog ? mix(fogColor.rgb / 255, result, fogFactor) : result;
+    vec3 finalColor = mix(fogColor.rgb / 255, result, fogFactor);
+#else
+    vec3 finalColor = result;
+#endif
     
-    FragColor = vec4(finalColor, objColor.a / 255 * texColor.a);
+    FragColor = vec4(finalColor, ObjColor.a / 255 * texColor.a);
 }
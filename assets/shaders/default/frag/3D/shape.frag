@@ -1,30 +1,44 @@
 #version 330 core
+// Variants (see ShaderVariants): USE_FOG mixes in the fog color
 out vec4 FragColor;
 
 in vec2 TexCoord;
 in vec3 FragPos;
+in vec4 ObjColor;
 
-uniform vec4 objColor;
 uniform sampler2D tex;
 
-uniform bool useFog;
-uniform float fogStart;
-uniform float fogEnd;
-uniform vec4 fogColor;
-
-uniform vec3 viewPos;
+#ifdef USE_FOG
+// Shared by every 3D shader (UniformBlocks::Fog)
+layout (std140) uniform Fog {
+    vec4 fogColor;
+    float fogStart;
+    float fogEnd;
+    bool useFog;
+};
+
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
+#endif
 
 void main() {
     vec4 texColor = texture(tex, TexCoord);
     if (texColor.a < 0.1) discard;
 
-    vec3 result = objColor.rgb / 255 * texColor.rgb;
+    vec3 result = ObjColor.rgb / 255 * texColor.rgb;
 
+#ifdef USE_FOG
     float dist = length(FragPos.xz - viewPos.xz);
 
     float fogFactor = clamp((fogStart - dist) / (fogStart - fogEnd), 0.0, 1.0);
 
-    vec3 finalColor = useFog ? mix(fogColor.rgb / 255, result, fogFactor) : result;
+    vec3 finalColor = mix(fogColor.rgb / 255, result, fogFactor);
+#else
+    vec3 finalColor = result;
+#endif
 
-    FragColor = vec4(finalColor, objColor.a / 255 * texColor.a);
+    FragColor = vec4(finalColor, ObjColor.a / 255 * texColor.a);
 }
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aColor;
+
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
+
+out vec4 VertexColor;
+
+void main() {
+    VertexColor = aColor;
+    gl_Position = projection * vec4(aPos, 0.0, 1.0);
+}
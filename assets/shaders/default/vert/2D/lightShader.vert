@@ -1,13 +1,18 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 projection;
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
 uniform vec3 offset;
 uniform mat4 transform;
 
 out vec2 FragPos;
 
 void main() {
-    FragPos = aPos.xy + offset.xy;
-    gl_Position = projection * transform * vec4(aPos + offset, 1.0);
+    vec4 worldPos = transform * vec4(aPos + offset, 1.0);
+    FragPos = worldPos.xy;
+    gl_Position = projection * worldPos;
 }
@@ -0,0 +1,36 @@
+#version 330 core
+// One instance per particle (ParticleSystem::Instance), the corners of the
+// unit quad come from gl_VertexID (drawn as a triangle strip)
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aSizeAngle;
+layout (location = 2) in vec4 aColor;
+
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
+
+// Texture size & uvRect of the particles of this draw
+uniform vec2 quadSize;
+uniform vec4 uvRect;
+
+out vec2 TexCoord;
+out vec4 VertexColor;
+
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    // Scaled & rotated (degrees) around the center of the texture
+    vec2 size = quadSize * aSizeAngle.x;
+    float rad = radians(aSizeAngle.y);
+    vec2 d = (corner - 0.5) * size;
+    vec2 pos = aPos + quadSize * 0.5 +
+               vec2(d.x * cos(rad) - d.y * sin(rad),
+                    d.x * sin(rad) + d.y * cos(rad));
+
+    TexCoord = vec2(mix(uvRect.x, uvRect.z, corner.x),
+                    mix(uvRect.w, uvRect.y, corner.y));
+    VertexColor = aColor;
+    gl_Position = projection * vec4(pos, 0.0, 1.0);
+}
@@ -2,9 +2,15 @@
 layout (location = 0) in vec4 vertex; // vec2 pos + vec2 tex
 out vec2 TexCoords;
 
-uniform mat4 projection;
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
+uniform vec2 offset;
+uniform float scale;
 
 void main() {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = projection * vec4(vertex.xy * scale + offset, 0.0, 1.0);
     TexCoords = vertex.zw;
 }
\ No newline at end of file
@@ -1,13 +1,24 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 2) in vec2 aTexCoord;
+// Only used by instanced draws (InstanceBatch)
+layout (location = 3) in vec2 aAtlasTexCoord;
+layout (location = 4) in vec3 aOffset;
+layout (location = 5) in vec3 aSize;
+layout (location = 7) in float aAtlas;
 
 out vec2 TexCoord;
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool instanced;
 
 void main() {
-    TexCoord = aTexCoord;
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    if (instanced) {
+        TexCoord = aAtlas > 0.5 ? aAtlasTexCoord : aTexCoord;
+        gl_Position = lightSpaceMatrix * vec4(aPos * aSize + aOffset, 1.0);
+    } else {
+        TexCoord = aTexCoord;
+        gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    }
 }
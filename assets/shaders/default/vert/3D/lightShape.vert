@@ -2,24 +2,54 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+// Only used by instanced draws (InstanceBatch)
+layout (location = 3) in vec2 aAtlasTexCoord;
+layout (location = 4) in vec3 aOffset;
+layout (location = 5) in vec3 aSize;
+layout (location = 6) in vec4 aColor;
+layout (location = 7) in float aAtlas;
 
 out vec2 TexCoord;
 out vec3 FragPos;
 out vec3 Normal;
+#ifdef USE_SHADOWS
 out vec4 FragPosLightSpace;
+#endif
+out vec4 ObjColor;
 
-uniform mat4 projection;
+// Shared by every shader (UniformBlocks::Camera)
+layout (std140) uniform Camera {
+    mat4 projection;
+    vec3 viewPos;
+};
 uniform vec3 offset;
 uniform mat4 transform;
+// Inverse transpose of transform, computed once per draw on the CPU
+uniform mat3 normalMatrix;
+#ifdef USE_SHADOWS
 uniform mat4 lightSpaceMatrix;
+#endif
+uniform vec4 objColor;
+uniform bool instanced;
 
 void main() {
-    vec3 worldPos = aPos + offset;
-    FragPos = vec3(transform * vec4(worldPos, 1.0));
-    Normal = mat3(transpose(inverse(transform))) * aNormal;
-    
+    if (instanced) {
+        FragPos = aPos * aSize + aOffset;
+        // Inverse transpose of a scale is the inverse scale
+        Normal = aNormal / aSize;
+        TexCoord = aAtlas > 0.5 ? aAtlasTexCoord : aTexCoord;
+        ObjColor = aColor * 255.0;
+    } else {
+        vec3 worldPos = aPos + offset;
+        FragPos = vec3(transform * vec4(worldPos, 1.0));
+        Normal = normalMatrix * aNormal;
+        TexCoord = aTexCoord;
+        ObjColor = objColor;
+    }
+
+#ifdef USE_SHADOWS
     FragPosLightSpace = lightSpaceMatrix * vec4(FragPos, 1.0);
-    
+#endif
+
     gl_Position = projection * vec4(FragPos, 1.0);
-    TexCoord = aTexCoord;
 }
@@ -0,0 +1,9 @@
+#version 300 es
+precision mediump float;
+out vec4 fragColor;
+
+in vec4 VertexColor;
+
+void main() {
+    fragColor = VertexColor;
+}
@@ -0,0 +1,58 @@
+#version 300 es
+precision mediump float;
+out vec4 fragColor;
+
+in vec2 FragPos;
+in vec4 VertexColor;
+
+
+struct PointLight {
+    vec2 position;
+    float radius;
+    float intensity;
+    vec4 color;
+};
+
+struct GlobalLight {
+    float intensity;
+    vec4 color;
+};
+
+// Shared by every 2D light shader (UniformBlocks::Lights2D)
+layout (std140) uniform Lights2D {
+    GlobalLight globalLight;
+    float ambient;
+    int numPointLights;
+    PointLight pointLights[32]; // Maximum are 32 point lights
+};
+
+vec3 CalcPointLight(PointLight l, vec2 fragPos, float ambient) {
+    float dist = length(l.position - fragPos);
+    float falloff = clamp(1.0 - dist / l.radius, 0.0, 1.0);
+
+    vec3 lightCol = l.color.rgb / 255.0 * l.intensity;
+
+    falloff = falloff * falloff; // optional smooth
+
+    return (ambient + falloff) * lightCol;
+}
+
+vec3 CalcGlobalLight(GlobalLight l) {
+    vec3 lightCol = l.color.rgb / 255.0 * l.intensity;
+    return lightCol;
+}
+
+void main() 
+{
+    vec3 result = vec3(ambient);
+
+    for (int i = 0; i < numPointLights; i++) {
+        result += CalcPointLight(pointLights[i], FragPos, ambient);
+    }
+    result += CalcGlobalLight(globalLight);
+
+    vec3 obj = VertexColor.rgb;
+    vec3 finalColor = obj * result;
+
+    fragColor = vec4(finalColor, VertexColor.a);
+}
@@ -0,0 +1,15 @@
+#version 300 es
+precision mediump float;
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 VertexColor;
+
+uniform sampler2D ourTexture;
+
+void main()
+{
+    vec4 textureColor = texture(ourTexture, TexCoord);
+    if (textureColor.a < 0.1) discard;
+    FragColor = VertexColor * textureColor;
+}
@@ -0,0 +1,113 @@
+#include "../CPLibrary/include/CPLibrary.h"
+#include <string>
+#include <vector>
+
+using namespace CPL;
+PRIORITIZE_GPU_BY_VENDOR
+
+// Amount of shapes drawn every frame & frames measured per run
+constexpr int SHAPES_PER_FRAME = 20000;
+constexpr int FRAMES = 200;
+
+enum class ShapeType : uint8_t {
+    RECT,
+    RECT_ROT,
+    RECT_OUT,
+    TRIANGLE,
+    CIRCLE,
+    LINE,
+};
+
+struct BenchShape {
+    ShapeType type;
+    glm::vec2 pos;
+    glm::vec2 size;
+    float angle;
+    Color color;
+};
+
+void DrawShape(const BenchShape &s) {
+    switch (s.type) {
+    case ShapeType::RECT:
+        DrawRect(s.pos, s.size, s.color);
+        break;
+    case ShapeType::RECT_ROT:
+        DrawRectRot(s.pos, s.size, s.angle, s.color);
+        break;
+    case ShapeType::RECT_OUT:
+        DrawRectOut(s.pos, s.size, s.color);
+        break;
+    case ShapeType::TRIANGLE:
+        DrawTriangle(s.pos, s.size, s.color);
+        break;
+    case ShapeType::CIRCLE:
+        DrawCircle(s.pos, s.size.x / 2, s.color);
+        break;
+    case ShapeType::LINE:
+        DrawLine(s.pos, s.pos + s.size, s.color);
+        break;
+    }
+}
+
+// Returns the amount of shapes per second
+double RunBenchmark(const std::vector<BenchShape> &shapes, const bool batching) {
+    EnableShapeBatching(batching);
+
+    int frames = 0;
+    const float start = GetTime();
+    while (frames < FRAMES && !WindowShouldClose()) {
+        UpdateCPL();
+        ClearBackground(BLACK);
+
+        BeginDraw(DrawModes::SHAPE_2D);
+        for (const auto &s : shapes)
+            DrawShape(s);
+        EndDraw();
+
+        // Wait for the GPU so the driver work is included in the timing
+        glFinish();
+        EndFrame();
+        frames++;
+    }
+    const float elapsed = GetTime() - start;
+    if (elapsed <= 0.0f)
+        return 0.0;
+    return static_cast<double>(shapes.size()) * frames / elapsed;
+}
+
+int main() {
+    // Create 1280x720 window with title
+    InitWindow({1280, 720}, "CPL 2D shape benchmark");
+    // VSync would cap the measured throughput
+    EnableVSync(false);
+
+    // Random shapes, same set for both runs
+    std::vector<BenchShape> shapes;
+    shapes.reserve(SHAPES_PER_FRAME);
+    for (int i = 0; i < SHAPES_PER_FRAME; i++) {
+        const auto type = static_cast<ShapeType>(RandInt(0, 5));
+        const float size = RandFloat(4, 24);
+        shapes.push_back({type,
+                          {RandFloat(0, GetScreenWidth()),
+                           RandFloat(0, GetScreenHeight())},
+                          {size, size},
+                          RandFloat(0, 360),
+                          Color(RandFloat(0, 255), RandFloat(0, 255),
+                                RandFloat(0, 255), 255)});
+    }
+
+    const double immediate = RunBenchmark(shapes, false);
+    const double batched = RunBenchmark(shapes, true);
+
+    Logging::Log(Logging::MessageStates::INFO,
+                 "Immediate: " + std::to_string(immediate) + " shapes/s");
+    Logging::Log(Logging::MessageStates::INFO,
+                 "Batched: " + std::to_string(batched) + " shapes/s");
+    if (immediate > 0.0) {
+        Logging::Log(Logging::MessageStates::INFO,
+                     "Speedup: " + std::to_string(batched / immediate) + "x");
+    }
+
+    // Close window
+    CloseWindow();
+}
@@ -54,12 +54,7 @@ void MainLoop() {
     // Draw tilemap
     g_Tilemap->Draw();
 
-    // Set transparency of particle depending on its lifetime
-    for (auto &p : g_ParticleSystem.particles) {
-        p.color.a = (1 - p.curLifeTime / p.lifeTime) * 255;
-    }
-
-    // Update & draw particles
+    // Update & draw particles (they fade out over their lifetime)
     g_ParticleSystem.Update();
     g_ParticleSystem.Draw();
 
@@ -117,7 +112,7 @@ int main() {
         "assets/images/example2D/smoke.png", {300, 300}, TextureFiltering::LINEAR));
 
     // Edit tilemap
-    g_Tilemap = std::make_unique<Tilemap>(Tilemap());
+    g_Tilemap = std::make_unique<Tilemap>();
     g_Tilemap->BeginEditing();
 
     for (int y = 3; y < 6; y++) {
@@ -134,14 +129,20 @@ int main() {
 
     // Set position of particle system
     g_ParticleSystem.pos = {GetScreenWidth() / 2, GetScreenHeight() / 2};
+    g_ParticleSystem.fadeOut = true;
+
+    // Smoke flying into every direction, growing while it fades out
+    ParticleEmitter smoke;
+    smoke.tex = g_SmokeTex.get();
+    smoke.minLifeTime = 0;
+    smoke.maxLifeTime = 10;
+    smoke.sizeCurve = {{0, 1.0f}, {1, 2.0f}};
+    g_ParticleSystem.SetEmitter(smoke);
 
-    // Set timer to spawn particles every 0.1 seconds
+    // Set timer to spawn a particle every 0.2 seconds
     Timer *particleSpawnTimer =
         TimerManager::AddTimer(0.2f, true, [](Timer *t) {
-            glm::vec2 direction = {glm::cos(RandFloat(0, 2 * 3.14)) * 50,
-                                   glm::sin(RandFloat(0, 2 * 3.14)) * 50};
-            g_ParticleSystem.AddParticle(g_SmokeTex.get(), WHITE, RandFloat(0, 10), direction,
-                           {0, 0});
+            g_ParticleSystem.Emit(1);
         });
 
 // Set Emscripten main loop if compiling to web else default
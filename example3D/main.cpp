@@ -52,26 +52,20 @@ void MainLoop() {
         glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     glm::mat4 lightSpaceMatrix = lightProjection * lightView;
 
-    Shader &depthShader = Engine::GetDepthShader();
-    depthShader.Use();
-    depthShader.SetMatrix4fv("lightSpaceMatrix", lightSpaceMatrix);
-
+    // Shapes drawn between Begin- & EndDepthPass are rendered into the
+    // shadow map (instanced like in the normal pass)
     g_ShadowMap->BeginDepthPass(lightSpaceMatrix);
 
-    CubeTex ground({0.0f, -0.1f, 0.0f}, {10.0f, 0.2f, 10.0f}, WHITE);
-    ground.DrawDepth(depthShader, g_GroundTex.get());
+    DrawCubeTex(g_GroundTex.get(), {0.0f, -0.1f, 0.0f}, {10.0f, 0.2f, 10.0f},
+                WHITE);
 
     if (drawCubes) {
-        for (auto &p : g_BlockPos) {
-            CubeTex cube(p, glm::vec3(0.2f), WHITE);
-            cube.DrawDepth(depthShader, g_GroundTex.get());
-        }
+        for (auto &p : g_BlockPos)
+            DrawCubeTex(g_GroundTex.get(), p, glm::vec3(0.2f), WHITE);
     }
     if (drawSpheres) {
-        for (auto &p : g_BlockPos) {
-            Sphere sphere(p, 0.1f, WHITE);
-            sphere.DrawDepth(depthShader);
-        }
+        for (auto &p : g_BlockPos)
+            DrawSphere(p, 0.1f, WHITE);
     }
 
     g_ShadowMap->EndDepthPass();